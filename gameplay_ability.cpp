@@ -22,17 +22,21 @@ constexpr auto _on_wait_completed = "_on_wait_completed";
 constexpr auto _on_wait_interrupted = "_on_wait_interrupted";
 constexpr auto _on_wait_cancelled = "_on_wait_cancelled";
 
-constexpr auto gameplay_ability_ready = "gameplay_ability_ready";
 } // namespace
 
 void GameplayAbilityTriggerData::set_trigger_tag(const String &value) {
 	trigger_tag = value;
+	trigger_pattern = GameplayTagPattern(value, true);
 }
 
 String GameplayAbilityTriggerData::get_trigger_tag() const {
 	return trigger_tag;
 }
 
+const GameplayTagPattern &GameplayAbilityTriggerData::get_trigger_pattern() const {
+	return trigger_pattern;
+}
+
 void GameplayAbilityTriggerData::set_trigger_type(AbilityTrigger::Type value) {
 	trigger_type = value;
 }
@@ -89,7 +93,31 @@ bool GameplayAbility::can_trigger(const String &trigger_tag, AbilityTrigger::Typ
 		if (trigger.is_null()) {
 			continue;
 		}
-		if (trigger->get_trigger_tag().matchn(trigger_tag) && trigger->get_trigger_type() == trigger_type) {
+		if (trigger->get_trigger_type() != trigger_type) {
+			continue;
+		}
+		if (trigger->get_trigger_pattern().match(trigger_tag)) {
+			return true;
+		}
+		if (GameplayTagRegistry::is_wildcard(trigger_tag) && trigger->get_trigger_tag().matchn(trigger_tag)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool GameplayAbility::can_trigger(const GameplayTagPattern &trigger_tag, AbilityTrigger::Type trigger_type) const {
+	for (auto &&variant : triggers) {
+		auto trigger = static_cast<Ref<GameplayAbilityTriggerData> >(variant);
+
+		if (trigger.is_null() || trigger->get_trigger_type() != trigger_type) {
+			continue;
+		}
+		if (trigger->get_trigger_pattern().match(trigger_tag.get_pattern())) {
+			return true;
+		}
+		if (!trigger_tag.is_exact() && trigger_tag.match(trigger->get_trigger_tag())) {
 			return true;
 		}
 	}
@@ -107,7 +135,7 @@ bool GameplayAbility::can_event_activate_ability(const Ref<GameplayEvent> &event
 
 bool GameplayAbility::try_event_activate_ability(const Ref<GameplayEvent> &event) {
 	if (has_method(_on_gameplay_event)) {
-		call_deferred(_on_gameplay_event, event);
+		defer_call(_on_gameplay_event, event);
 		return true;
 	} else {
 		return false;
@@ -178,13 +206,13 @@ bool GameplayAbility::try_activate_ability() {
 	}
 
 	active = true;
-	call_deferred(_on_activate_ability);
+	defer_call(_on_activate_ability);
 	return true;
 }
 
 void GameplayAbility::activate_ability() {
 	active = true;
-	call_deferred(_on_activate_ability);
+	defer_call(_on_activate_ability);
 	source->add_active_ability(this);
 }
 
@@ -204,7 +232,7 @@ void GameplayAbility::end_ability() {
 	if (active) {
 		active = false;
 		reset_wait_handle();
-		call_deferred(_on_end_ability, false);
+		defer_call(_on_end_ability, false);
 
 		source->remove_active_ability(this);
 	}
@@ -214,7 +242,7 @@ void GameplayAbility::cancel_ability() {
 	if (active) {
 		active = false;
 		reset_wait_handle();
-		call_deferred(_on_end_ability, true);
+		defer_call(_on_end_ability, true);
 
 		source->remove_active_ability(this);
 	}
@@ -225,21 +253,7 @@ double GameplayAbility::get_remaining_cooldown() const {
 		return 0;
 	}
 
-	auto tags = cooldown_effect->get_effect_tags();
-	auto effects = source->query_active_effects(tags);
-
-	if (effects.empty()) {
-		return 0;
-	}
-
-	Vector<double> effect_durations;
-
-	for (Node *node : effects) {
-		auto effect_node = static_cast<GameplayEffectNode *>(node);
-		effect_durations.push_back(effect_node->get_duration());
-	}
-	std::sort(begin(effect_durations), end(effect_durations));
-	return effect_durations[effect_durations.size() - 1];
+	return source->get_remaining_cooldown(cooldown_effect->get_effect_tags());
 }
 
 bool GameplayAbility::check_ability_cost() const {
@@ -337,6 +351,11 @@ StringName GameplayAbility::get_ability_name() const {
 
 void GameplayAbility::set_triggers(const Array &value) {
 	triggers = value;
+
+	if (source) {
+		source->unindex_triggers(this);
+		source->index_triggers(this);
+	}
 }
 
 const Array &GameplayAbility::get_triggers() const {
@@ -447,6 +466,8 @@ void GameplayAbility::wait_delay(double seconds) {
 void GameplayAbility::wait_event(const String &event_tag) {
 	handle_wait_interrupt(WaitType::Event);
 	wait_handle.data = event_tag;
+	wait_handle.pattern = GameplayTagPattern(event_tag, true);
+	subscribe_wait();
 }
 
 void GameplayAbility::wait_action_pressed(const StringName &action) {
@@ -462,31 +483,37 @@ void GameplayAbility::wait_action_released(const StringName &action) {
 void GameplayAbility::wait_attribute_change(const StringName &attribute) {
 	handle_wait_interrupt(WaitType::AttributeChanged);
 	wait_handle.data = attribute;
+	subscribe_wait();
 }
 
 void GameplayAbility::wait_base_attribute_change(const StringName &attribute) {
 	handle_wait_interrupt(WaitType::BaseAttributeChanged);
 	wait_handle.data = attribute;
+	subscribe_wait();
 }
 
 void GameplayAbility::wait_effect_added(const Ref<GameplayEffect> &effect) {
 	handle_wait_interrupt(WaitType::EffectAdded);
 	wait_handle.data = effect;
+	subscribe_wait();
 }
 
 void GameplayAbility::wait_effect_removed(const Ref<GameplayEffect> &effect) {
 	handle_wait_interrupt(WaitType::EffectRemoved);
 	wait_handle.data = effect;
+	subscribe_wait();
 }
 
 void GameplayAbility::wait_tag_added(const String &tag) {
 	handle_wait_interrupt(WaitType::TagAdded);
 	wait_handle.data = tag;
+	subscribe_wait();
 }
 
 void GameplayAbility::wait_tag_removed(const String &tag) {
 	handle_wait_interrupt(WaitType::TagRemoved);
 	wait_handle.data = tag;
+	subscribe_wait();
 }
 
 void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &data) {
@@ -500,7 +527,7 @@ void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &d
 			auto delay = static_cast<double>(wait_handle.data);
 
 			if (delay - delta <= 0) {
-				call_deferred(_on_wait_completed, wait_handle.type);
+				defer_call(_on_wait_completed, wait_handle.type);
 				wait_handle.type = WaitType::None;
 			} else {
 				wait_handle.data = delay - delta;
@@ -508,10 +535,9 @@ void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &d
 		} break;
 		case WaitType::Event: {
 			auto event_tag = static_cast<String>(data);
-			auto wait_event = static_cast<String>(wait_handle.data);
 
-			if (event_tag.matchn(wait_event)) {
-				call_deferred(_on_wait_completed, wait_handle.type, event_tag);
+			if (wait_handle.pattern.match(event_tag)) {
+				defer_call(_on_wait_completed, wait_handle.type, event_tag);
 				wait_handle.type = WaitType::None;
 			}
 		} break;
@@ -520,7 +546,7 @@ void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &d
 			auto input_action = static_cast<StringName>(wait_handle.data);
 
 			if (input->is_action_pressed(input_action)) {
-				call_deferred(_on_wait_completed, wait_handle.type, input_action);
+				defer_call(_on_wait_completed, wait_handle.type, input_action);
 				wait_handle.type = WaitType::None;
 			}
 		} break;
@@ -529,7 +555,7 @@ void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &d
 			auto input_action = static_cast<StringName>(wait_handle.data);
 
 			if (input->is_action_released(input_action)) {
-				call_deferred(_on_wait_completed, wait_handle.type, input_action);
+				defer_call(_on_wait_completed, wait_handle.type, input_action);
 				wait_handle.type = WaitType::None;
 			}
 		} break;
@@ -539,17 +565,19 @@ void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &d
 			auto wait_attribute = static_cast<StringName>(wait_handle.data);
 
 			if (wait_attribute == attribute) {
-				call_deferred(_on_wait_completed, wait_handle.type, attribute);
+				defer_call(_on_wait_completed, wait_handle.type, attribute);
 				wait_handle.type = WaitType::None;
 			}
 		} break;
 		case WaitType::EffectAdded:
-		case WaitType::EffectRemoved: {
+		case WaitType::EffectRemoved:
+		case WaitType::EffectStackAdded:
+		case WaitType::EffectStackRemoved: {
 			auto effect = static_cast<Ref<GameplayEffect> >(data);
 			auto wait_effect = static_cast<Ref<GameplayEffect> >(wait_handle.data);
 
-			if (wait_effect->get_effect_name() == effect->get_effect_name()) {
-				call_deferred(_on_wait_completed, wait_handle.type, effect);
+			if (effect.is_valid() && wait_effect.is_valid() && wait_effect->get_effect_name() == effect->get_effect_name()) {
+				defer_call(_on_wait_completed, wait_handle.type, effect);
 				wait_handle.type = WaitType::None;
 			}
 		} break;
@@ -559,7 +587,7 @@ void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &d
 			auto wait_tag = static_cast<String>(wait_handle.data);
 
 			if (wait_tag == tag) {
-				call_deferred(_on_wait_completed, wait_handle.type, tag);
+				defer_call(_on_wait_completed, wait_handle.type, tag);
 				wait_handle.type = WaitType::None;
 			}
 		} break;
@@ -569,11 +597,6 @@ void GameplayAbility::process_wait(WaitType::Type process_type, const Variant &d
 }
 
 void GameplayAbility::ability_process(double delta) {
-	if (cooldown_effect.is_valid()) {
-		if (get_remaining_cooldown() <= 0) {
-			source->emit_signal(gameplay_ability_ready, source, this);
-		}
-	}
 	if (active) {
 		if (source->get_active_tags()->has_any(source_blocked_tags)) {
 			source->cancel_ability(this);
@@ -628,6 +651,11 @@ Array GameplayAbility::filter_targets() {
 void GameplayAbility::_notification(int notification) {
 	GameplayNode::_notification(notification);
 
+	// Abilities of world processed systems are ticked by the GameplayWorld.
+	if (source && source->is_world_processing()) {
+		return;
+	}
+
 	switch (notification) {
 		case NOTIFICATION_INTERNAL_PROCESS: {
 			if (!is_queued_for_deletion() && should_ability_process) {
@@ -647,7 +675,7 @@ void GameplayAbility::_notification(int notification) {
 
 void GameplayAbility::handle_wait_cancel() {
 	if (wait_handle.type != WaitType::None) {
-		call_deferred(_on_wait_cancelled, wait_handle.type);
+		defer_call(_on_wait_cancelled, wait_handle.type);
 	}
 	wait_handle.type = WaitType::None;
 }
@@ -655,12 +683,18 @@ void GameplayAbility::handle_wait_cancel() {
 void GameplayAbility::handle_wait_interrupt(WaitType::Type wait_type) {
 	if (wait_handle.type != wait_type) {
 		if (wait_handle.type != WaitType::None) {
-			call_deferred(_on_wait_interrupted, wait_type);
+			defer_call(_on_wait_interrupted, wait_type);
 		}
 		wait_handle.type = wait_type;
 	}
 }
 
+void GameplayAbility::subscribe_wait() {
+	if (source) {
+		source->subscribe_wait(this);
+	}
+}
+
 void GameplayAbility::reset_wait_handle() {
 	wait_handle.type = WaitType::None;
 	wait_handle.data = {};
@@ -1,13 +1,13 @@
 #pragma once
 
 #include "gameplay_node.h"
+#include "gameplay_tags.h"
 
 #include <core/hash_map.h>
 #include <core/resource.h>
 #include <scene/main/node.h>
 
 class GameplayAbilitySystem;
-class GameplayTagContainer;
 class GameplayEffect;
 class GameplayEvent;
 class InputEvent;
@@ -57,12 +57,15 @@ public:
 
 	void set_trigger_tag(const String &value);
 	String get_trigger_tag() const;
+	const GameplayTagPattern &get_trigger_pattern() const;
 	void set_trigger_type(AbilityTrigger::Type value);
 	AbilityTrigger::Type get_trigger_type() const;
 
 private:
 	/** Tag that will trigger the ability. */
 	String trigger_tag;
+	/** Compiled trigger tag. */
+	GameplayTagPattern trigger_pattern;
 	/** Flags on how ability will get triggered. */
 	AbilityTrigger::Type trigger_type = AbilityTrigger::GampeplayEvent;
 
@@ -96,6 +99,8 @@ public:
 	struct WaitData {
 		WaitType::Type type = WaitType::None;
 		Variant data;
+		/** Compiled pattern for event waits. */
+		GameplayTagPattern pattern;
 	};
 
 	GameplayAbility();
@@ -114,6 +119,7 @@ public:
 
 	/** Returns true if tag triggers ability. */
 	bool can_trigger(const String &trigger_tag, AbilityTrigger::Type trigger_type) const;
+	bool can_trigger(const GameplayTagPattern &trigger_tag, AbilityTrigger::Type trigger_type) const;
 	/** Checks trigger and then either calls _can_event_activate_ability or returns true. */
 	bool can_event_activate_ability(const Ref<GameplayEvent> &event);
 	/** Tries to activate ability via given gameplay event. */
@@ -237,6 +243,7 @@ protected:
 
 	void handle_wait_cancel();
 	void handle_wait_interrupt(WaitType::Type wait_type);
+	void subscribe_wait();
 	void reset_wait_handle();
 
 private:
@@ -287,6 +294,8 @@ private:
 
 	bool should_ability_process = true;
 	bool should_ability_input = true;
+	/** Last trigger lookup of the source which visited this ability, so abilities in several buckets are visited once. */
+	uint64_t trigger_visit = 0;
 
 	static bool check_tag_requirement(const Ref<GameplayTagContainer> &tags, const Ref<GameplayTagContainer> &required, const Ref<GameplayTagContainer> &blocked);
 
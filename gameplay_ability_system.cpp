@@ -4,12 +4,15 @@
 #include "gameplay_effect.h"
 #include "gameplay_effect_magnitude.h"
 #include "gameplay_tags.h"
+#include "gameplay_world.h"
 
 #include <core/os/input.h>
 #include <core/os/input_event.h>
+#include <scene/main/scene_tree.h>
 #include <scene/resources/packed_scene.h>
 
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <numeric>
 
@@ -29,16 +32,86 @@ constexpr auto gameplay_ability_ready = "gameplay_ability_ready";
 
 constexpr auto gameplay_attribute_changed = "gameplay_attribute_changed";
 constexpr auto gameplay_base_attribute_changed = "gameplay_base_attribute_changed";
+
+uint64_t make_wait_key(WaitType::Type wait_type, uint32_t key) {
+	return (static_cast<uint64_t>(wait_type) << 32) | key;
+}
+
+/** Returns the subscription key of a wait handle or false if it can't be keyed. */
+bool get_wait_key(const GameplayAbility::WaitData &wait_handle, uint32_t &key) {
+	switch (wait_handle.type) {
+		case WaitType::Event: {
+			key = wait_handle.pattern.get_id();
+			return wait_handle.pattern.is_exact();
+		}
+		case WaitType::AttributeChanged:
+		case WaitType::BaseAttributeChanged: {
+			key = static_cast<StringName>(wait_handle.data).hash();
+			return true;
+		}
+		case WaitType::EffectAdded:
+		case WaitType::EffectRemoved:
+		case WaitType::EffectStackAdded:
+		case WaitType::EffectStackRemoved: {
+			auto effect = static_cast<Ref<GameplayEffect> >(wait_handle.data);
+			key = effect.is_valid() ? effect->get_effect_name().hash() : 0;
+			return effect.is_valid();
+		}
+		case WaitType::TagAdded:
+		case WaitType::TagRemoved: {
+			key = GameplayTagRegistry::get_singleton()->intern(wait_handle.data);
+			return key != GAMEPLAY_TAG_INVALID;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+/** Amount of effect records per pool page. */
+constexpr int effect_page_size = 64;
+
+template <class K>
+void add_indexed_effect(HashMap<K, Vector<int> > &effects, const K &key, int index) {
+	auto &&indexed = effects[key];
+
+	// Effects are indexed in order of activation, a duplicate can only be the last entry.
+	if (indexed.empty() || indexed[indexed.size() - 1] != index) {
+		indexed.push_back(index);
+	}
+}
+
+template <class K>
+void remove_indexed_effect(HashMap<K, Vector<int> > &effects, const K &key, int index) {
+	if (auto indexed = effects.getptr(key)) {
+		indexed->erase(index);
+
+		if (indexed->empty()) {
+			effects.erase(key);
+		}
+	}
+}
+
+bool is_waiting_on(const GameplayAbility *ability, WaitType::Type wait_type, uint32_t key) {
+	uint32_t wait_key = 0;
+	auto &&wait_handle = ability->get_wait_handle();
+	return wait_handle.type == wait_type && get_wait_key(wait_handle, wait_key) && wait_key == key;
+}
 } // namespace
 
 void GameplayEvent::set_event_tag(const String &value) {
 	event_tag = value;
+	event_pattern = GameplayTagPattern(value);
 }
 
 const String &GameplayEvent::get_event_tag() const {
 	return event_tag;
 }
 
+const GameplayTagPattern &GameplayEvent::get_event_pattern() const {
+	return event_pattern;
+}
+
 void GameplayEvent::add_event_target(Node *target) {
 	if (auto system = dynamic_cast<GameplayAbilitySystem *>(target)) {
 		event_targets.push_back(target);
@@ -58,326 +131,65 @@ void GameplayEvent::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "event_tag"), "set_event_tag", "get_event_tag");
 }
 
-void GameplayEffectNode::initialise(GameplayAbilitySystem *source, GameplayAbilitySystem *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) {
-	this->source = source;
-	this->target = target;
-	this->effect = effect;
-	this->level = level;
-	this->normalised_level = normalised_level;
-}
-
 Node *GameplayEffectNode::get_source() const {
-	return source;
+	return is_valid() ? system->get_effect_record(effect_index).source : nullptr;
 }
 
 Node *GameplayEffectNode::get_target() const {
-	return target;
+	return system;
 }
 
 Ref<GameplayEffect> GameplayEffectNode::get_effect() const {
-	return effect;
+	return is_valid() ? system->get_effect_record(effect_index).effect : Ref<GameplayEffect>();
 }
 
 double GameplayEffectNode::get_duration() const {
-	return duration;
+	return is_valid() ? system->get_remaining_duration(system->get_effect_record(effect_index)) : 0.0;
 }
 
 int64_t GameplayEffectNode::get_stacks() const {
-	if (auto system = get_stacking_system()) {
-		auto effect_name = effect->get_effect_name();
-
-		if (system->effect_stacking.has(effect_name)) {
-			return system->effect_stacking.get(effect_name).stacks;
-		} else {
-			return 1;
-		}
-	} else {
-		return internal_stacks;
-	}
+	return is_valid() ? system->get_effect_stacks(system->get_effect_record(effect_index)) : 0;
 }
 
 int64_t GameplayEffectNode::get_level() const {
-	return level;
+	return is_valid() ? system->get_effect_record(effect_index).level : 0;
 }
 
 double GameplayEffectNode::get_normalised_level() const {
-	return normalised_level;
+	return is_valid() ? system->get_effect_record(effect_index).normalised_level : 0.0;
 }
 
 void GameplayEffectNode::add_stack(int64_t value) {
-	using ActiveEffectEntry = GameplayAbilitySystem::ActiveEffectEntry;
-
-	if (value <= 0) {
-		if (value < 0) {
-			remove_stack(-value);
-		}
-	} else if (auto system = get_stacking_system()) {
-		auto effect_name = effect->get_effect_name();
-
-		if (system->effect_stacking.has(effect_name)) {
-			auto &&effect_entry = system->effect_stacking.get(effect_name);
-			auto current_stacks = effect_entry.stacks;
-			auto stacks = current_stacks + value;
-			stack_overflow = stacks > effect->get_maximum_stacks();
-
-			if (!stack_applied) {
-				previous_stack = current_stacks;
-			}
-			if (stack_overflow) {
-				stacks = effect->get_maximum_stacks();
-			}
-
-			effect_entry.stacks = stacks;
-		} else {
-			system->effect_stacking.set(effect_name, ActiveEffectEntry{ this, level, value });
-		}
-
-		stack_applied = true;
+	if (is_valid()) {
+		system->add_effect_stack(effect_index, value);
 	}
 }
 
 void GameplayEffectNode::remove_stack(int64_t value) {
-	if (value <= 0) {
-		if (value < 0) {
-			add_stack(-value);
-		}
-	} else if (auto system = get_stacking_system()) {
-		auto effect_name = effect->get_effect_name();
-		auto has_effect = system->effect_stacking.has(effect_name);
-
-		if (has_effect) {
-			auto &&effect_entry = system->effect_stacking.get(effect_name);
-			auto current_stacks = effect_entry.stacks;
-			auto stacks = current_stacks - value;
-
-			if (!stack_applied) {
-				previous_stack = current_stacks;
-			}
-
-			effect_entry.stacks = stacks;
-		} else {
-			WARN_PRINT("No effect present to remove.");
-		}
-
-		stack_applied = true;
-	} else {
-		internal_stacks = 0;
-		stack_applied = true;
+	if (is_valid()) {
+		system->remove_effect_stack(effect_index, value);
 	}
 }
 
 void GameplayEffectNode::effect_process(double delta) {
-	bool duration_refreshed = false;
-
-	if (effect->get_duration_type() == DurationType::Instant) {
-		queue_delete();
-		return;
+	if (is_valid()) {
+		system->advance_effect(effect_index, delta);
 	}
-	if (effect->get_duration_type() == DurationType::HasDuration) {
-		duration -= delta;
-
-		if (duration <= 0) {
-			switch (effect->get_stack_expiration()) {
-				case StackExpiration::ClearStack: {
-					apply_effects(effect->get_normal_expiration_effects());
-					end_effect(false);
-				} break;
-				case StackExpiration::RefreshDuration: {
-					duration = calculate_duration();
-					duration_refreshed = true;
-				} break;
-				case StackExpiration::RemoveSingleStackAndRefreshDuration: {
-					duration = calculate_duration();
-					duration_refreshed = true;
-					remove_stack(1);
-				} break;
-				default: {
-				} break;
-			}
-		}
-	}
-	if (stack_applied) {
-		auto stacks = get_stacks();
-
-		if (stacks <= 0) {
-			if (effect->get_duration_type() == DurationType::HasDuration) {
-				end_effect(!duration_refreshed && duration > 0);
-			} else {
-				end_effect(true);
-			}
-		} else if (previous_stack != stacks) {
-			if (previous_stack < stacks) {
-				execute_effect();
-			}
-			if (effect->get_duration_refresh() == StackDurationRefresh::OnApplication) {
-				duration = calculate_duration();
-			}
-			if (effect->get_period_reset() == StackPeriodReset::OnApplication) {
-				period = 0;
-			}
-		}
-	}
-	if (effect->get_period().is_valid()) {
-		auto threshold = calculate_period_threshold();
-		period += delta;
-
-		if (period >= threshold) {
-			period -= threshold;
-			execute_effect();
-		}
-	}
-	if (stack_overflow) {
-		apply_effects(effect->get_overflow_effects());
-
-		if (effect->get_clear_overflow_stack()) {
-			remove_stack(get_stacks());
-		}
-	}
-
-	stack_overflow = false;
-	stack_applied = false;
 }
 
 void GameplayEffectNode::set_effect_process(bool value) {
-	should_effect_process = value;
-}
-
-void GameplayEffectNode::_notification(int notification) {
-	GameplayNode::_notification(notification);
-
-	switch (notification) {
-		case NOTIFICATION_PARENTED: {
-			start_effect();
-		} break;
-		case NOTIFICATION_INTERNAL_PROCESS: {
-			if (should_effect_process) {
-				auto delta = get_process_delta_time();
-				effect_process(delta);
-			}
-		} break;
-		default: {
-		} break;
-	}
-}
-
-double GameplayEffectNode::calculate_duration() const {
-	auto duration_magnitude = effect->get_duration_magnitude();
-
-	if (duration_magnitude.is_valid()) {
-		return duration_magnitude->calculate_magnitude(source, target, effect, level, normalised_level);
-	} else {
-		return 0;
-	}
-}
-
-double GameplayEffectNode::calculate_period_threshold() const {
-	auto period_magnitude = effect->get_period();
-
-	if (period_magnitude.is_valid()) {
-		return period_magnitude->calculate_magnitude(source, target, effect, level, normalised_level);
-	} else {
-		return 0;
-	}
-}
-
-void GameplayEffectNode::apply_effect(const Ref<GameplayEffect> &effect) {
-	if (!is_queued_for_deletion()) {
-		target->apply_effect(source, effect, 1, level, normalised_level);
-	}
-}
-
-void GameplayEffectNode::apply_effects(const Array &effects) {
-	if (!is_queued_for_deletion()) {
-		target->apply_effects(source, effects, 1, level, normalised_level);
-	}
-}
-
-void GameplayEffectNode::execute_effect() {
-	if (!is_queued_for_deletion()) {
-		if (target->get_active_tags()->has_all(effect->get_ongoing_tags())) {
-			target->execute_effect(this);
-		}
-	}
-}
-
-GameplayAbilitySystem *GameplayEffectNode::get_stacking_system() const {
-	switch (effect->get_stacking_type()) {
-		case StackingType::AggregateOnSource: {
-			return source;
-		} break;
-		case StackingType::AggregateOnTarget: {
-			return target;
-		} break;
-		default: {
-			return nullptr;
-		} break;
-	}
-}
-
-void GameplayEffectNode::start_effect() {
-	switch (effect->get_duration_type()) {
-		case DurationType::Instant: {
-			execute_effect();
-			queue_delete();
-			return; // Remove instant effects immediately.
-		} break;
-		case DurationType::HasDuration: {
-			ERR_FAIL_COND(effect->get_duration_magnitude().is_null());
-			duration = calculate_duration();
-		} break;
-		default: {
-		} break;
-	}
-
-	// Tags
-	target->add_tags(effect->get_target_tags());
-
-	// Abilities
-	for (Ref<PackedScene> packed_scene : effect->get_granted_abilities()) {
-		if (auto node = packed_scene->instance()) {
-			if (auto ability = dynamic_cast<GameplayAbility *>(node)) {
-				granted_abilities.push_back(ability);
-				target->add_ability(ability);
-			}
-		}
+	if (is_valid()) {
+		system->set_effect_processing(effect_index, value);
 	}
-
-	// Period execution
-	if (effect->get_period().is_valid() && effect->get_execute_period_on_application()) {
-		execute_effect();
-	} else if (effect->get_duration_type() == DurationType::Infinite) {
-		execute_effect();
-	}
-
-	target->active_effects.push_back(this);
-	target->emit_signal(gameplay_effect_activated, target, effect);
 }
 
-void GameplayEffectNode::end_effect(bool cancelled) {
-	// Abilities
-	for (auto ability : granted_abilities) {
-		target->remove_ability(ability);
-	}
-
-	// Expiration Effects
-	if (cancelled) {
-		apply_effects(effect->get_premature_expiration_effects());
-	} else {
-		apply_effects(effect->get_normal_expiration_effects());
+bool GameplayEffectNode::is_valid() const {
+	if (!system) {
+		return false;
 	}
 
-	// Tags
-	target->remove_tags(effect->get_target_tags());
-
-	// Reset Duration
-	duration = 0;
-
-	// Signal
-	target->emit_signal(gameplay_effect_ended, target, effect, cancelled);
-
-	// Purge
-	target->active_effects.erase(this);
-	queue_delete();
+	auto &&record = system->get_effect_record(effect_index);
+	return record.generation == generation && !record.removed;
 }
 
 void GameplayEffectNode::_bind_methods() {
@@ -390,6 +202,7 @@ void GameplayEffectNode::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_normalised_level"), &GameplayEffectNode::get_normalised_level);
 	ClassDB::bind_method(D_METHOD("effect_process", "delta"), &GameplayEffectNode::effect_process);
 	ClassDB::bind_method(D_METHOD("set_effect_process", "value"), &GameplayEffectNode::set_effect_process);
+	ClassDB::bind_method(D_METHOD("is_valid"), &GameplayEffectNode::is_valid);
 }
 
 GameplayAbilitySystem::GameplayAbilitySystem() {
@@ -410,6 +223,32 @@ GameplayAbilitySystem::GameplayAbilitySystem() {
 	/** Synchronised Methods */
 	rpc_config("sync_apply_cue", MultiplayerAPI::RPC_MODE_REMOTESYNC);
 	rpc_config("sync_remove_cue", MultiplayerAPI::RPC_MODE_REMOTESYNC);
+
+	random_seed = GameplayRandom::mix(get_instance_id());
+}
+
+GameplayAbilitySystem::~GameplayAbilitySystem() {
+	if (world_index >= 0) {
+		GameplayWorld::get_singleton()->unregister_system(this);
+	}
+
+	for (int i = 0, n = effect_pages.size(); i < n; i++) {
+		auto page = effect_pages[i];
+
+		for (int j = 0; j < effect_page_size; j++) {
+			if (auto proxy = page[j].proxy) {
+				proxy->system = nullptr;
+
+				if (SceneTree::get_singleton()) {
+					proxy->queue_delete();
+				} else {
+					memdelete(proxy);
+				}
+			}
+		}
+
+		memdelete_arr(page);
+	}
 }
 
 const Ref<GameplayAttributeSet> &GameplayAbilitySystem::get_attributes() const {
@@ -458,12 +297,8 @@ const Ref<GameplayTagContainer> &GameplayAbilitySystem::get_persistent_cues() co
 Array GameplayAbilitySystem::query_active_effects_by_tag(const String &tag) const {
 	Array result;
 
-	for (auto effect_node : active_effects) {
-		auto &&effect = effect_node->get_effect();
-
-		if (!effect_node->is_queued_for_deletion() && effect->get_effect_tags()->has_tag(tag)) {
-			result.append(effect_node);
-		}
+	for (auto index : find_effects_with_tag(tag)) {
+		result.append(get_effect_proxy(index));
 	}
 
 	return result;
@@ -472,12 +307,8 @@ Array GameplayAbilitySystem::query_active_effects_by_tag(const String &tag) cons
 Array GameplayAbilitySystem::query_active_effects(const Ref<GameplayTagContainer> &tags) const {
 	Array result;
 
-	for (auto effect_node : active_effects) {
-		auto &&effect = effect_node->get_effect();
-
-		if (!effect_node->is_queued_for_deletion() && effect->get_effect_tags()->has_any(tags)) {
-			result.append(effect_node);
-		}
+	for (auto index : find_effects_with_tags(tags)) {
+		result.append(get_effect_proxy(index));
 	}
 
 	return result;
@@ -488,11 +319,42 @@ double GameplayAbilitySystem::get_remaining_effect_duration(const Ref<GameplayEf
 		return 0;
 	}
 
-	auto effect_node = std::find_if(begin(active_effects), end(active_effects), [&effect](GameplayEffectNode *node) {
-		return node->get_effect()->get_effect_name() == effect->get_effect_name();
-	});
+	if (auto effects = effects_by_name.getptr(effect->get_effect_name())) {
+		return get_remaining_duration(get_effect_record((*effects)[0]));
+	}
+
+	return 0.0;
+}
+
+double GameplayAbilitySystem::get_longest_remaining_duration(const Ref<GameplayTagContainer> &tags) const {
+	auto result = 0.0;
 
-	return effect_node != end(active_effects) ? (*effect_node)->get_duration() : 0.0;
+	for (auto index : find_effects_with_tags(tags)) {
+		result = MAX(result, get_remaining_duration(get_effect_record(index)));
+	}
+
+	return result;
+}
+
+double GameplayAbilitySystem::get_remaining_cooldown(const Ref<GameplayTagContainer> &tags) const {
+	ERR_FAIL_COND_V(tags.is_null(), 0.0);
+
+	auto result = 0.0;
+
+	for (int i = 0, n = tags->size(); i < n; i++) {
+		auto id = tags->get_tag_id(i);
+
+		// Wildcards aren't part of the cooldown table.
+		if (id == GAMEPLAY_TAG_INVALID) {
+			return get_longest_remaining_duration(tags);
+		}
+
+		if (auto cooldown = cooldowns.getptr(id)) {
+			result = MAX(result, MAX(cooldown->expiration - effect_clock, cooldown->paused_remaining));
+		}
+	}
+
+	return result;
 }
 
 bool GameplayAbilitySystem::handle_event(const Ref<GameplayEvent> &event) {
@@ -502,14 +364,14 @@ bool GameplayAbilitySystem::handle_event(const Ref<GameplayEvent> &event) {
 
 	auto result = false;
 
-	for (auto ability : abilities) {
-		if (ability->is_active()) {
-			ability->process_wait(WaitType::Event, event->get_event_tag());
-		} else if (ability->can_trigger(event->get_event_tag(), AbilityTrigger::GampeplayEvent)) {
+	notify_event_wait(event->get_event_tag());
+
+	for_each_triggered_ability(event->get_event_tag(), AbilityTrigger::GampeplayEvent, [&](GameplayAbility *ability) {
+		if (!ability->is_active() && ability->can_trigger(event->get_event_pattern(), AbilityTrigger::GampeplayEvent)) {
 			ability->targets = event->get_event_targets();
 			result = ability->try_activate_ability() || result;
 		}
-	}
+	});
 
 	return result;
 }
@@ -527,48 +389,50 @@ Ref<GameplayAttributeData> GameplayAbilitySystem::get_attribute_data(const Strin
 }
 
 double GameplayAbilitySystem::get_base_attribute_value(const StringName &name) const {
-	return get_attribute_data(name)->get_base_value();
+	auto index = attributes->get_attribute_index(name);
+	ERR_FAIL_COND_V(index == GAMEPLAY_ATTRIBUTE_INVALID, 0.0);
+	return attributes->get_base_value(index);
 }
 
 double GameplayAbilitySystem::get_current_attribute_value(const StringName &name) const {
-	return get_attribute_data(name)->get_current_value();
+	auto index = attributes->get_attribute_index(name);
+	ERR_FAIL_COND_V(index == GAMEPLAY_ATTRIBUTE_INVALID, 0.0);
+	return attributes->get_current_value(index);
 }
 
 bool GameplayAbilitySystem::update_base_attribute(const StringName &name, double value, UpdateAttributeOperation::Type operation /*= UpdateAttributeOperation::None*/) {
-	if (has_attribute(name)) {
-		auto attribute = get_attribute_data(name);
-		auto old_base = attribute->get_base_value();
-		auto old_value = attribute->get_current_value();
+	auto index = attributes->get_attribute_index(name);
+
+	if (index != GAMEPLAY_ATTRIBUTE_INVALID) {
+		auto old_base = attributes->get_base_value(index);
+		auto old_value = attributes->get_current_value(index);
 
 		switch (operation) {
 			case UpdateAttributeOperation::None: {
-				attribute->set_base_value(value);
+				attributes->set_base_value(index, value);
+				attributes->set_current_value(index, old_value);
 			} break;
 			case UpdateAttributeOperation::Relative: {
 				auto factor = old_value / old_base;
-				attribute->set_base_value(value);
-				attribute->set_current_value(old_value * factor);
+				attributes->set_base_value(index, value);
+				attributes->set_current_value(index, old_value * factor);
 			} break;
 			case UpdateAttributeOperation::Absolute: {
 				auto delta = old_value - old_base;
-				attribute->set_base_value(value);
-				attribute->set_current_value(old_value + delta);
+				attributes->set_base_value(index, value);
+				attributes->set_current_value(index, old_value + delta);
 			} break;
 			case UpdateAttributeOperation::Override: {
-				attribute->set_base_value(value);
-				attribute->set_current_value(value);
+				attributes->set_base_value(index, value);
+				attributes->set_current_value(index, value);
 			} break;
 			default: {
 			} break;
 		}
 
-		for (auto &&ability : abilities) {
-			if (ability->is_active()) {
-				ability->process_wait(WaitType::BaseAttributeChanged, name);
-			}
-		}
+		notify_wait(WaitType::BaseAttributeChanged, name.hash(), name);
 
-		emit_signal(gameplay_base_attribute_changed, this, attribute, old_base, old_value);
+		emit_gameplay_signal(gameplay_base_attribute_changed, this, attributes->get_attribute_by_index(index)->get_attribute_data(), old_base, old_value);
 		return true;
 	} else {
 		return false;
@@ -576,62 +440,44 @@ bool GameplayAbilitySystem::update_base_attribute(const StringName &name, double
 }
 
 void GameplayAbilitySystem::add_tag(const String &tag) {
-	active_tags->append(tag);
-
-	for (auto &&ability : abilities) {
-		if (ability->is_active()) {
-			ability->process_wait(WaitType::TagAdded, tag);
-		} else if (ability->can_trigger(tag, AbilityTrigger::OwnedTagAdded)) {
-			ability->targets = targets;
-			ability->activate_ability();
-		}
+	if (increment_tag(tag)) {
+		notify_tag_added(tag);
 	}
 }
 
 void GameplayAbilitySystem::add_tags(const Ref<GameplayTagContainer> &tags) {
-	active_tags->append_tags(tags);
-
-	for (auto &&ability : abilities) {
-		if (ability->get_triggers().empty()) {
-			continue;
-		}
+	const auto array = tags->get_tags();
+	Vector<String> added_tags;
 
-		for (auto &&tag : tags) {
-			if (ability->is_active()) {
-				ability->process_wait(WaitType::TagAdded, tag);
-			} else if (ability->can_trigger(tag, AbilityTrigger::OwnedTagAdded)) {
-				ability->targets = targets;
-				ability->activate_ability();
-			}
+	// Update all tags before notifying, abilities may check the whole set.
+	for (int i = 0, n = array.size(); i < n; i++) {
+		if (increment_tag(array[i])) {
+			added_tags.push_back(array[i]);
 		}
 	}
+	for (auto &&tag : added_tags) {
+		notify_tag_added(tag);
+	}
 }
 
 void GameplayAbilitySystem::remove_tag(const String &tag) {
-	active_tags->remove(tag);
+	Vector<String> removed_tags;
+	decrement_tag(tag, removed_tags);
 
-	for (auto &&ability : abilities) {
-		if (ability->is_active()) {
-			ability->process_wait(WaitType::TagRemoved, tag);
-		} else if (ability->can_trigger(tag, AbilityTrigger::OwnedTagRemoved)) {
-			ability->targets = targets;
-			ability->activate_ability();
-		}
+	for (auto &&removed_tag : removed_tags) {
+		notify_tag_removed(removed_tag);
 	}
 }
 
 void GameplayAbilitySystem::remove_tags(const Ref<GameplayTagContainer> &tags) {
-	active_tags->remove_tags(tags);
+	const auto array = tags->get_tags();
+	Vector<String> removed_tags;
 
-	for (auto ability : abilities) {
-		for (auto &&tag : tags) {
-			if (ability->is_active()) {
-				ability->process_wait(WaitType::TagRemoved, tag);
-			} else if (ability->can_trigger(tag, AbilityTrigger::OwnedTagRemoved)) {
-				ability->targets = targets;
-				ability->activate_ability();
-			}
-		}
+	for (int i = 0, n = array.size(); i < n; i++) {
+		decrement_tag(array[i], removed_tags);
+	}
+	for (auto &&removed_tag : removed_tags) {
+		notify_tag_removed(removed_tag);
 	}
 }
 
@@ -639,9 +485,10 @@ void GameplayAbilitySystem::add_ability(Node *node) {
 	if (auto ability = dynamic_cast<GameplayAbility *>(node)) {
 		abilities.push_back(ability);
 		ability->initialise(this);
+		index_triggers(ability);
 
 		if (ability->get_parent() != this) {
-			call_deferred("add_child", node);
+			defer_call("add_child", node);
 		}
 	}
 }
@@ -658,12 +505,14 @@ void GameplayAbilitySystem::remove_ability(Node *node) {
 
 		if (index >= 0) {
 			abilities.remove(index);
+			unindex_triggers(ability);
+			unsubscribe_waits(ability);
 
 			if (ability->is_active()) {
 				active_abilities.erase(ability);
 			}
 
-			ability->queue_delete();
+			ability->defer_delete();
 		}
 	}
 }
@@ -688,9 +537,9 @@ void GameplayAbilitySystem::activate_ability(Node *node) {
 
 			ability->targets = targets;
 			ability->activate_ability();
-			emit_signal(gameplay_ability_activated, this, ability);
+			emit_gameplay_signal(gameplay_ability_activated, this, ability);
 		} else {
-			emit_signal(gameplay_ability_blocked, this, ability);
+			emit_gameplay_signal(gameplay_ability_blocked, this, ability);
 		}
 	}
 }
@@ -698,7 +547,7 @@ void GameplayAbilitySystem::activate_ability(Node *node) {
 void GameplayAbilitySystem::cancel_ability(Node *node) {
 	if (auto ability = dynamic_cast<GameplayAbility *>(node)) {
 		ability->cancel_ability();
-		emit_signal(gameplay_ability_cancelled, this, ability);
+		emit_gameplay_signal(gameplay_ability_cancelled, this, ability);
 	}
 }
 
@@ -707,35 +556,37 @@ bool GameplayAbilitySystem::can_apply_effect(Node *source, const Ref<GameplayEff
 		return false;
 	}
 
-	for (auto &&node : active_effects) {
-		auto &&active_effect = node->get_effect();
+	auto spec = effect->get_spec();
 
-		if (*active_effect == *effect) {
-			if (node->get_stacks() + stacks > effect->get_maximum_stacks() && effect->get_deny_overflow_application()) {
+	if (auto effects = effects_by_definition.getptr(effect->get_instance_id())) {
+		for (auto index : *effects) {
+			if (get_effect_stacks(get_effect_record(index)) + stacks > spec->get_maximum_stacks() && spec->get_deny_overflow_application()) {
 				return false;
 			}
 		}
-		if (effect->get_effect_tags()->has_any(active_effect->get_application_immunity_tags())) {
-			return false;
-		}
+	}
+	if (is_immune_to(spec->get_effect_tags())) {
+		return false;
 	}
 
-	for (Ref<GameplayEffectCustomApplicationRequirement> custom_requirement : effect->get_application_requirements()) {
+	for (auto &&custom_requirement : spec->get_application_requirements()) {
 		if (!custom_requirement->execute(source, this, effect, level, normalised_level)) {
 			return false;
 		}
 	}
 
-	auto &&modifiers = effect->get_modifiers();
-	return std::all_of(begin(modifiers), end(modifiers), [&](Ref<GameplayEffectModifier> modifier) {
-		auto attribute_name = modifier->get_attribute();
-		ERR_FAIL_COND_V(!attributes->has_attribute(attribute_name), false);
+	auto &&modifiers = spec->get_modifiers();
+	return std::all_of(begin(modifiers), end(modifiers), [&](const GameplayEffectSpec::Modifier &modifier) {
+		auto index = modifier.attribute.resolve(attributes.ptr());
+
+		if (index == GAMEPLAY_ATTRIBUTE_INVALID) {
+			return false;
+		}
 
-		auto magnitude = modifier->get_modifier_magnitude()->calculate_magnitude(source, this, effect, level, normalised_level);
-		auto attribute = attributes->get_attribute_data(attribute_name);
-		auto value = attribute->get_current_value();
+		auto magnitude = modifier.magnitude->calculate_magnitude(source, this, effect, level, normalised_level);
+		auto value = attributes->get_current_value(index);
 
-		return execute_magnitude(magnitude, value, modifier->get_modifier_operation()) >= 0;
+		return execute_magnitude(magnitude, value, modifier.operation) >= 0;
 	});
 }
 
@@ -763,12 +614,18 @@ bool GameplayAbilitySystem::try_apply_effect(Node *source, const Ref<GameplayEff
 void GameplayAbilitySystem::apply_effect(Node *node, const Ref<GameplayEffect> &effect, int64_t stacks /*= 1*/, int64_t level /*= 1*/, double normalised_level /*= 1*/) {
 	if (auto source = dynamic_cast<GameplayAbilitySystem *>(node)) {
 		if (can_apply_effect(source, effect, stacks, level, normalised_level)) {
-			if (effect->get_infliction_chance().is_valid() && rgenerator(rengine) > effect->get_infliction_chance()->calculate_magnitude(source, this, effect, level, normalised_level)) {
-				emit_signal(gameplay_effect_infliction_failed, this, effect);
+			auto spec = effect->get_spec();
+			auto &&infliction_chance = spec->get_infliction_chance();
+
+			if (infliction_chance.is_valid() && roll_random() > infliction_chance->calculate_magnitude(source, this, effect, level, normalised_level)) {
+				emit_gameplay_signal(gameplay_effect_infliction_failed, this, effect);
+			} else if (spec->get_duration_type() == DurationType::Instant) {
+				// Instant effects never stack, they are executed right away.
+				execute_instant_effect(source, effect, level, normalised_level);
 			} else {
 				GameplayAbilitySystem *aggregate_source = nullptr;
 
-				switch (effect->get_stacking_type()) {
+				switch (spec->get_stacking_type()) {
 					case StackingType::AggregateOnSource: {
 						aggregate_source = source;
 					} break;
@@ -780,27 +637,28 @@ void GameplayAbilitySystem::apply_effect(Node *node, const Ref<GameplayEffect> &
 				}
 
 				if (aggregate_source) {
-					auto effect_name = effect->get_effect_name();
+					auto &&effect_name = spec->get_effect_name();
 					auto &&stacking = aggregate_source->effect_stacking;
 
 					if (stacking.has(effect_name)) {
 						auto &&effect_data = stacking[effect_name];
 
 						if (effect_data.level == level) {
-							auto effect_node = stacking[effect_name].effect_node;
-							effect_node->add_stack(stacks);
-
-							for (auto ability : active_abilities) {
-								ability->process_wait(WaitType::EffectStackAdded, effect_node);
+							if (find_effect_record(effect_data)) {
+								effect_data.target->add_effect_stack(effect_data.effect_index, stacks);
 							}
+							notify_effect_wait(WaitType::EffectStackAdded, effect);
 						} else if (effect_data.level < level) {
-							auto effect_node = stacking[effect_name].effect_node;
-							active_effects.erase(effect_node);
+							auto entry = effect_data;
 							stacking.erase(effect_name);
-							effect_node->queue_delete();
+
+							if (find_effect_record(entry)) {
+								entry.target->remove_modifiers(entry.effect_index);
+								entry.target->release_effect(entry.effect_index);
+							}
 							add_effect(source, effect, stacks, level, normalised_level);
 						} else {
-							emit_signal(gameplay_effect_infliction_failed, this, effect);
+							emit_gameplay_signal(gameplay_effect_infliction_failed, this, effect);
 						}
 					} else {
 						add_effect(source, effect, stacks, level, normalised_level);
@@ -831,16 +689,14 @@ void GameplayAbilitySystem::remove_effect(Node *node, const Ref<GameplayEffect>
 				aggregate_source = this;
 			} break;
 			default: {
-				for (auto effect_node : active_effects) {
-					if (effect_node->get_effect()->get_effect_name() == effect->get_effect_name()) {
-						active_effects.erase(effect_node);
-						effect_node->queue_delete();
-
-						for (auto ability : active_abilities) {
-							ability->process_wait(WaitType::EffectStackRemoved, effect_node);
-							ability->process_wait(WaitType::EffectRemoved, effect_node);
-						}
-					}
+				auto named_effects = effects_by_name.getptr(effect->get_effect_name());
+				const auto effects = named_effects ? *named_effects : Vector<int>();
+
+				for (auto index : effects) {
+					remove_modifiers(index);
+					release_effect(index);
+					notify_effect_wait(WaitType::EffectStackRemoved, effect);
+					notify_effect_wait(WaitType::EffectRemoved, effect);
 				}
 
 				return;
@@ -852,23 +708,18 @@ void GameplayAbilitySystem::remove_effect(Node *node, const Ref<GameplayEffect>
 			auto &&stacking = aggregate_source->effect_stacking;
 
 			if (stacking.has(effect_name)) {
-				auto &&effect_data = stacking[effect_name];
-				auto effect_node = effect_data.effect_node;
+				auto entry = stacking[effect_name];
+				auto record = find_effect_record(entry);
 
-				if (effect_data.level > level) {
-					emit_signal(gameplay_effect_removal_failed, this, effect);
-				} else {
-					effect_node->remove_stack(stacks);
+				if (entry.level > level) {
+					emit_gameplay_signal(gameplay_effect_removal_failed, this, effect);
+				} else if (record) {
+					entry.target->remove_effect_stack(entry.effect_index, stacks);
 
-					if (effect_node->get_stacks() <= 0) {
-						for (auto ability : active_abilities) {
-							ability->process_wait(WaitType::EffectStackRemoved, effect_node);
-							ability->process_wait(WaitType::EffectRemoved, effect_node);
-						}
-					} else {
-						for (auto ability : active_abilities) {
-							ability->process_wait(WaitType::EffectStackRemoved, effect_node);
-						}
+					notify_effect_wait(WaitType::EffectStackRemoved, effect);
+
+					if (entry.target->get_effect_stacks(*record) <= 0) {
+						notify_effect_wait(WaitType::EffectRemoved, effect);
 					}
 				}
 			}
@@ -877,18 +728,10 @@ void GameplayAbilitySystem::remove_effect(Node *node, const Ref<GameplayEffect>
 }
 
 void GameplayAbilitySystem::remove_effect_node(Node *, Node *node, int64_t stacks /*= 1*/, int64_t level /*= 1*/) {
-	if (auto effect_node = dynamic_cast<GameplayEffectNode *>(node)) {
-		auto &&effect = effect_node->get_effect();
-
-		if (effect_node->get_level() > level) {
-			emit_signal(gameplay_effect_removal_failed, this, effect);
-		} else {
-			effect_node->remove_stack(stacks);
+	auto effect_node = dynamic_cast<GameplayEffectNode *>(node);
 
-			for (auto ability : active_abilities) {
-				ability->process_wait(WaitType::EffectRemoved, effect);
-			}
-		}
+	if (effect_node && effect_node->is_valid()) {
+		effect_node->system->remove_active_effect(effect_node->effect_index, stacks, level);
 	}
 }
 
@@ -896,12 +739,12 @@ void GameplayAbilitySystem::apply_cue(const String &cue, double level /*= 1*/, d
 	if (persistent) {
 		persistent_cues->append(cue);
 	}
-	emit_signal(gameplay_cue_activated, this, cue, level, magnitude, persistent);
+	emit_gameplay_signal(gameplay_cue_activated, this, cue, level, magnitude, persistent);
 }
 
 void GameplayAbilitySystem::remove_cue(const String &cue) {
 	persistent_cues->remove(cue);
-	emit_signal(gameplay_cue_removed, this, cue);
+	emit_gameplay_signal(gameplay_cue_removed, this, cue);
 }
 
 int64_t GameplayAbilitySystem::get_stack_count(const Ref<GameplayEffect> &effect) const {
@@ -928,8 +771,52 @@ const Ref<GameplayAttributeSet> &GameplayAbilitySystem::get_attribute_set() cons
 	return attributes;
 }
 
-void GameplayAbilitySystem::add_target(Node *value) {
-	targets.append(value);
+void GameplayAbilitySystem::set_random_seed(uint64_t value) {
+	random_seed = value;
+	random_sequence.store(0, std::memory_order_relaxed);
+}
+
+uint64_t GameplayAbilitySystem::get_random_seed() const {
+	return random_seed;
+}
+
+void GameplayAbilitySystem::set_random_sequence(uint64_t value) {
+	random_sequence.store(value, std::memory_order_relaxed);
+}
+
+uint64_t GameplayAbilitySystem::get_random_sequence() const {
+	return random_sequence.load(std::memory_order_relaxed);
+}
+
+void GameplayAbilitySystem::set_world_processing(bool value) {
+	if (world_processing == value) {
+		return;
+	}
+
+	world_processing = value;
+
+	if (is_inside_tree()) {
+		auto world = GameplayWorld::get_singleton();
+		ERR_FAIL_NULL(world);
+
+		if (value) {
+			world->register_system(this);
+		} else {
+			world->unregister_system(this);
+		}
+	}
+}
+
+bool GameplayAbilitySystem::is_world_processing() const {
+	return world_processing;
+}
+
+double GameplayAbilitySystem::roll_random() {
+	return GameplayRandom::unit(random_seed, random_sequence.fetch_add(1, std::memory_order_relaxed));
+}
+
+void GameplayAbilitySystem::add_target(Node *value) {
+	targets.append(value);
 }
 
 void GameplayAbilitySystem::remove_target(Node *value) {
@@ -946,27 +833,80 @@ const Array &GameplayAbilitySystem::get_targets() const {
 
 void GameplayAbilitySystem::_notification(int notification) {
 	GameplayNode::_notification(notification);
+
+	switch (notification) {
+		case NOTIFICATION_ENTER_TREE: {
+			if (world_processing) {
+				auto world = GameplayWorld::get_singleton();
+				ERR_FAIL_NULL(world);
+				world->register_system(this);
+			}
+		} break;
+		case NOTIFICATION_EXIT_TREE: {
+			if (world_index >= 0) {
+				GameplayWorld::get_singleton()->unregister_system(this);
+			}
+		} break;
+		case NOTIFICATION_INTERNAL_PROCESS: {
+			if (!world_processing) {
+				process_effects(get_process_delta_time());
+			}
+		} break;
+		default: {
+		} break;
+	}
+}
+
+void GameplayAbilitySystem::execute_instant_effect(GameplayAbilitySystem *source, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) {
+	ActiveEffect record;
+	record.source = source;
+	record.effect = effect;
+	record.spec = effect->get_spec();
+	record.level = level;
+	record.normalised_level = normalised_level;
+	execute_effect(record, -1);
+
+	notify_effect_wait(WaitType::EffectAdded, effect);
+	notify_effect_wait(WaitType::EffectStackAdded, effect);
+}
+
+void GameplayAbilitySystem::execute_effect(int index, int64_t ticks /*= 1*/) {
+	execute_effect(get_effect_record(index), index, ticks);
 }
 
-void GameplayAbilitySystem::execute_effect(GameplayEffectNode *node) {
-	auto source = static_cast<GameplayAbilitySystem *>(node->get_source());
-	auto target = static_cast<GameplayAbilitySystem *>(node->get_target());
-	auto effect = node->get_effect();
-	auto level = node->get_level();
-	auto normalised_level = node->get_normalised_level();
+void GameplayAbilitySystem::execute_effect(ActiveEffect &record, int index, int64_t ticks /*= 1*/) {
+	auto source = record.source;
+	auto target = this;
+	auto spec = record.spec;
+	auto level = record.level;
+	auto normalised_level = record.normalised_level;
 	auto trigger_effects = false;
 
+	if (record.removed || !active_tags->has_all(spec->get_ongoing_tags())) {
+		return;
+	}
+
 	// Apply modifiers via period or instantly.
-	auto &&modifiers = effect->get_modifiers();
-	apply_modifiers(node, modifiers);
+	if (spec->is_aggregated()) {
+		record.applied_executions.push_back(AppliedExecution{ record.applied_modifiers.size(), get_effect_stacks(record) });
+	}
+
+	apply_modifiers(record, spec->get_modifiers(), ticks);
 
 	// Apply custom executions.
-	for (Ref<GameplayEffectCustomExecution> execution : effect->get_executions()) {
-		auto result = execution->execute(source, target, node, level, normalised_level);
-		auto &&modifiers = result->get_modifiers();
+	for (auto &&execution : spec->get_executions()) {
+		auto effect_node = index >= 0 ? get_effect_proxy(index) : nullptr;
+		auto result = execution->execute(source, target, effect_node, level, normalised_level);
+		auto &&result_modifiers = result->get_modifiers();
+
+		if (result_modifiers.size()) {
+			Vector<GameplayEffectSpec::Modifier> modifiers;
+
+			for (Ref<GameplayEffectModifier> modifier : result_modifiers) {
+				modifiers.push_back(GameplayEffectSpec::compile_modifier(modifier));
+			}
 
-		if (modifiers.size()) {
-			apply_modifiers(node, modifiers);
+			apply_modifiers(record, modifiers);
 		}
 
 		trigger_effects = result->should_trigger_additional_effects() || trigger_effects;
@@ -974,9 +914,7 @@ void GameplayAbilitySystem::execute_effect(GameplayEffectNode *node) {
 
 	// Check if conditional effects should be triggered.
 	if (trigger_effects) {
-		auto &&effects = effect->get_conditional_erffects();
-
-		for (Ref<ConditionalGameplayEffect> conditional : effects) {
+		for (auto &&conditional : spec->get_conditional_effects()) {
 			if (conditional->can_apply(source->get_active_tags())) {
 				target->apply_effect(source, conditional->get_effect(), 1, level, normalised_level);
 			}
@@ -984,61 +922,394 @@ void GameplayAbilitySystem::execute_effect(GameplayEffectNode *node) {
 	}
 
 	// Remove effects which have removal tags.
-	auto &&removal_effects = target->query_active_effects(effect->get_remove_effect_tags());
-	for (Node *child : removal_effects) {
-		auto effect_node = static_cast<GameplayEffectNode *>(child);
-		target->remove_effect_node(source, child, std::numeric_limits<int32_t>::max(), effect_node->get_level());
+	auto &&remove_effect_tags = spec->get_remove_effect_tags();
+
+	for (auto effect_index : find_effects_with_tags(remove_effect_tags)) {
+		auto &&active_effect = get_effect_record(effect_index);
+
+		if (!active_effect.removed && active_effect.spec->get_effect_tags()->has_any(remove_effect_tags)) {
+			remove_active_effect(effect_index, std::numeric_limits<int32_t>::max(), active_effect.level);
+		}
 	}
 
 	// Iterate all active abilities and check if they should be cancelled.
 	for (auto &&ability : active_abilities) {
-		if (ability->get_ability_tags()->has_any(effect->get_cancel_ability_tags())) {
+		if (ability->get_ability_tags()->has_any(spec->get_cancel_ability_tags())) {
 			ability->cancel_ability();
 		}
 	}
 }
 
-void GameplayAbilitySystem::apply_modifiers(GameplayEffectNode *node, const Array &modifiers) {
-	auto source = static_cast<GameplayAbilitySystem *>(node->get_source());
-	auto target = static_cast<GameplayAbilitySystem *>(node->get_target());
-	auto effect = node->get_effect();
+void GameplayAbilitySystem::apply_modifiers(ActiveEffect &record, const Vector<GameplayEffectSpec::Modifier> &modifiers, int64_t ticks /*= 1*/) {
+	auto source = record.source;
+	auto target = this;
+	auto effect = record.effect;
+	auto aggregated = record.spec->is_aggregated();
 
-	struct AttributeChanges {
-		Ref<GameplayAttribute> attribute;
-		double old_value = 0;
-	};
+	Vector<AttributeChange> changes;
+
+	for (auto &&modifier : modifiers) {
+		auto index = modifier.attribute.resolve(attributes.ptr());
+
+		if (index == GAMEPLAY_ATTRIBUTE_INVALID) {
+			continue;
+		}
+
+		auto magnitude = modifier.magnitude->calculate_magnitude(source, target, effect, record.level, record.normalised_level) * ticks;
+		track_attribute_change(changes, index);
+
+		if (aggregated) {
+			// Lasting effects contribute to the aggregator so they can be removed again.
+			GameplayAttributeModifier attribute_modifier;
+			attribute_modifier.index = index;
+
+			switch (modifier.operation) {
+				case ModifierOperation::Add: {
+					attribute_modifier.magnitude = magnitude;
+				} break;
+				case ModifierOperation::Subtract: {
+					attribute_modifier.magnitude = -magnitude;
+				} break;
+				case ModifierOperation::Multiply: {
+					attribute_modifier.type = GameplayAttributeModifier::Multiplicative;
+					attribute_modifier.magnitude = magnitude;
+				} break;
+				case ModifierOperation::Divide: {
+					ERR_CONTINUE(magnitude == 0);
+					attribute_modifier.type = GameplayAttributeModifier::Multiplicative;
+					attribute_modifier.magnitude = 1.0 / magnitude;
+				} break;
+				case ModifierOperation::Override: {
+					attribute_modifier.type = GameplayAttributeModifier::Override;
+					attribute_modifier.magnitude = magnitude;
+				} break;
+			}
+
+			attributes->add_modifier(attribute_modifier);
+			record.applied_modifiers.push_back(attribute_modifier);
+		} else {
+			// Instant and periodic executions permanently change the current value, the base value stays untouched.
+			auto value = attributes->get_current_value(index);
+			attributes->set_current_value(index, execute_magnitude(magnitude, value, modifier.operation));
+		}
+	}
+
+	notify_attribute_changes(changes);
+}
+
+void GameplayAbilitySystem::remove_modifiers(int index, int64_t stacks /*= 0*/) {
+	auto &&record = get_effect_record(index);
+	auto &&executions = record.applied_executions;
+	auto count = executions.size();
+
+	// An execution stays while any of the stacks it has been applied for remain.
+	while (count > 0 && (count > 1 ? executions[count - 2].stacks : 0) >= stacks) {
+		count--;
+	}
+
+	// A partially removed execution only covers the remaining stacks, later stacks execute again.
+	if (count > 0 && executions[count - 1].stacks > stacks) {
+		executions.ptrw()[count - 1].stacks = stacks;
+	}
+
+	if (count == executions.size()) {
+		return;
+	}
+
+	Vector<AttributeChange> changes;
+	auto first = executions[count].offset;
+
+	for (int i = record.applied_modifiers.size() - 1; i >= first; i--) {
+		auto &&modifier = record.applied_modifiers[i];
+		track_attribute_change(changes, modifier.index);
+		attributes->remove_modifier(modifier);
+	}
+
+	record.applied_modifiers.resize(first);
+	executions.resize(count);
+	notify_attribute_changes(changes);
+}
+
+void GameplayAbilitySystem::track_attribute_change(Vector<AttributeChange> &changes, GameplayAttributeIndex index) const {
+	auto tracked = std::any_of(begin(changes), end(changes), [&](const AttributeChange &change) {
+		return change.index == index;
+	});
+
+	if (!tracked) {
+		changes.push_back(AttributeChange{ index, attributes->get_current_value(index) });
+	}
+}
+
+void GameplayAbilitySystem::notify_attribute_changes(const Vector<AttributeChange> &changes) {
+	for (auto &&change : changes) {
+		auto attribute = attributes->get_attribute_by_index(change.index);
+		auto &&attribute_name = attributes->get_schema()->get_name(change.index);
+
+		notify_wait(WaitType::AttributeChanged, attribute_name.hash(), attribute_name);
+
+		emit_gameplay_signal(gameplay_attribute_changed, this, attribute, change.old_value);
+	}
+}
+
+bool GameplayAbilitySystem::increment_tag(const String &tag) {
+	auto id = GameplayTagRegistry::get_singleton()->intern(tag);
+
+	if (id == GAMEPLAY_TAG_INVALID) {
+		if (!tag.empty()) {
+			WARN_PRINTS("Wildcard tags can't be owned: " + tag);
+		}
+
+		return false;
+	} else if (!active_tags->has_tag_id(id)) {
+		tag_counts.set(id, 1);
+		active_tags->append(tag);
+		return true;
+	} else if (auto count = tag_counts.getptr(id)) {
+		(*count)++;
+	} else {
+		// Tag was appended to the container directly.
+		tag_counts.set(id, 2);
+	}
+
+	return false;
+}
+
+void GameplayAbilitySystem::decrement_tag(const String &tag, Vector<String> &removed_tags) {
+	if (tag.empty()) {
+		return;
+	} else if (GameplayTagRegistry::is_wildcard(tag)) {
+		GameplayTagPattern pattern(tag);
+		const auto array = active_tags->get_tags();
+
+		// Every matching tag loses a single reference.
+		for (int i = 0, n = array.size(); i < n; i++) {
+			if (!GameplayTagRegistry::is_wildcard(array[i]) && pattern.match(array[i])) {
+				decrement_tag(array[i], removed_tags);
+			}
+		}
+
+		return;
+	}
+
+	auto id = GameplayTagRegistry::get_singleton()->find(tag);
+
+	if (!active_tags->has_tag_id(id)) {
+		tag_counts.erase(id);
+		return;
+	}
+
+	auto count = tag_counts.getptr(id);
+
+	if (count && *count > 1) {
+		(*count)--;
+	} else {
+		tag_counts.erase(id);
+		active_tags->remove_tag_id(id);
+		removed_tags.push_back(tag);
+	}
+}
+
+void GameplayAbilitySystem::notify_tag_added(const String &tag) {
+	notify_wait(WaitType::TagAdded, GameplayTagRegistry::get_singleton()->find(tag), tag);
+	for_each_triggered_ability(tag, AbilityTrigger::OwnedTagAdded, [&](GameplayAbility *ability) {
+		if (!ability->is_active() && ability->can_trigger(tag, AbilityTrigger::OwnedTagAdded)) {
+			ability->targets = targets;
+			ability->activate_ability();
+		}
+	});
+}
+
+void GameplayAbilitySystem::notify_tag_removed(const String &tag) {
+	notify_wait(WaitType::TagRemoved, GameplayTagRegistry::get_singleton()->find(tag), tag);
+	for_each_triggered_ability(tag, AbilityTrigger::OwnedTagRemoved, [&](GameplayAbility *ability) {
+		if (!ability->is_active() && ability->can_trigger(tag, AbilityTrigger::OwnedTagRemoved)) {
+			ability->targets = targets;
+			ability->activate_ability();
+		}
+	});
+}
+
+void GameplayAbilitySystem::subscribe_wait(GameplayAbility *ability) {
+	auto &&wait_handle = ability->get_wait_handle();
+	uint32_t key = 0;
+	Vector<GameplayAbility *> *bucket = nullptr;
+
+	if (get_wait_key(wait_handle, key)) {
+		auto wait_key = make_wait_key(wait_handle.type, key);
+
+		if (!wait_subscriptions.has(wait_key)) {
+			wait_subscriptions.set(wait_key, Vector<GameplayAbility *>());
+		}
+
+		bucket = &wait_subscriptions.get(wait_key);
+	} else if (wait_handle.type == WaitType::Event && !wait_handle.pattern.is_empty()) {
+		bucket = &wait_event_patterns;
+	}
+
+	if (bucket && bucket->find(ability) == -1) {
+		bucket->push_back(ability);
+	}
+}
+
+void GameplayAbilitySystem::unsubscribe_waits(GameplayAbility *ability) {
+	for (auto key = wait_subscriptions.next(nullptr); key; key = wait_subscriptions.next(key)) {
+		wait_subscriptions.get(*key).erase(ability);
+	}
+
+	wait_event_patterns.erase(ability);
+}
+
+void GameplayAbilitySystem::notify_wait(WaitType::Type wait_type, uint32_t key, const Variant &data) {
+	auto wait_key = make_wait_key(wait_type, key);
+	auto bucket = wait_subscriptions.getptr(wait_key);
+
+	if (!bucket) {
+		return;
+	}
+
+	// Waits may complete or get replaced while processing.
+	const auto subscribers = *bucket;
+
+	for (auto ability : subscribers) {
+		if (ability->is_active()) {
+			ability->process_wait(wait_type, data);
+		}
+	}
+
+	// Drop abilities which are no longer waiting on this key.
+	if ((bucket = wait_subscriptions.getptr(wait_key))) {
+		for (int i = bucket->size() - 1; i >= 0; i--) {
+			if (!is_waiting_on((*bucket)[i], wait_type, key)) {
+				bucket->remove(i);
+			}
+		}
 
-	HashMap<StringName, AttributeChanges> changes;
+		if (bucket->empty()) {
+			wait_subscriptions.erase(wait_key);
+		}
+	}
+}
+
+void GameplayAbilitySystem::notify_effect_wait(WaitType::Type wait_type, const Ref<GameplayEffect> &effect) {
+	if (effect.is_valid()) {
+		notify_wait(wait_type, effect->get_effect_name().hash(), effect);
+	}
+}
+
+void GameplayAbilitySystem::notify_event_wait(const String &event_tag) {
+	notify_wait(WaitType::Event, GameplayTagRegistry::get_singleton()->find(event_tag), event_tag);
+
+	if (wait_event_patterns.empty()) {
+		return;
+	}
+
+	const auto subscribers = wait_event_patterns;
+
+	for (auto ability : subscribers) {
+		if (ability->is_active()) {
+			ability->process_wait(WaitType::Event, event_tag);
+		}
+	}
+
+	for (int i = wait_event_patterns.size() - 1; i >= 0; i--) {
+		auto &&wait_handle = wait_event_patterns[i]->get_wait_handle();
 
-	for (Ref<GameplayEffectModifier> modifier : modifiers) {
-		auto magnitude = modifier->get_modifier_magnitude()->calculate_magnitude(source, target, effect, node->get_level(), node->get_normalised_level());
-		auto attribute_name = modifier->get_attribute();
-		ERR_FAIL_COND(!attributes->has_attribute(attribute_name));
+		if (wait_handle.type != WaitType::Event || wait_handle.pattern.is_exact()) {
+			wait_event_patterns.remove(i);
+		}
+	}
+}
+
+void GameplayAbilitySystem::index_triggers(GameplayAbility *ability) {
+	for (auto &&variant : ability->get_triggers()) {
+		auto trigger = static_cast<Ref<GameplayAbilityTriggerData> >(variant);
+
+		if (trigger.is_null() || trigger->get_trigger_pattern().is_empty()) {
+			continue;
+		}
+
+		auto &&pattern = trigger->get_trigger_pattern();
+		auto &&index = trigger_index[trigger->get_trigger_type()];
+		Vector<GameplayAbility *> *bucket = nullptr;
 
-		auto attribute = attributes->get_attribute(attribute_name);
-		auto attribute_data = attribute->get_attribute_data();
-		auto value = attribute_data->get_current_value();
+		if (pattern.is_exact()) {
+			if (!index.tags.has(pattern.get_id())) {
+				index.tags.set(pattern.get_id(), Vector<GameplayAbility *>());
+			}
+			bucket = &index.tags.get(pattern.get_id());
+		} else if (pattern.is_descendants()) {
+			if (!index.descendants.has(pattern.get_id())) {
+				index.descendants.set(pattern.get_id(), Vector<GameplayAbility *>());
+			}
+			bucket = &index.descendants.get(pattern.get_id());
+		} else {
+			bucket = &index.patterns;
+		}
+
+		if (bucket->find(ability) == -1) {
+			bucket->push_back(ability);
+		}
+		if (index.abilities.find(ability) == -1) {
+			index.abilities.push_back(ability);
+		}
+	}
+}
 
-		if (!changes.has(attribute_name)) {
-			changes.set(attribute_name, AttributeChanges{ attribute, value });
+void GameplayAbilitySystem::unindex_triggers(GameplayAbility *ability) {
+	// Triggers may have changed since indexing, purge every bucket.
+	for (auto &&index : trigger_index) {
+		for (auto key = index.tags.next(nullptr); key; key = index.tags.next(key)) {
+			index.tags.get(*key).erase(ability);
+		}
+		for (auto key = index.descendants.next(nullptr); key; key = index.descendants.next(key)) {
+			index.descendants.get(*key).erase(ability);
 		}
 
-		value = execute_magnitude(magnitude, value, modifier->get_modifier_operation());
-		attribute_data->set_current_value(value);
+		index.patterns.erase(ability);
+		index.abilities.erase(ability);
 	}
+}
+
+template <class Function>
+void GameplayAbilitySystem::for_each_triggered_ability(const String &tag, AbilityTrigger::Type trigger_type, Function &&function) {
+	auto &&index = trigger_index[trigger_type];
+	auto visit = ++trigger_visits;
 
-	auto pairs = make_gameplay_ptr<const decltype(changes)::Pair *[]>(changes.size());
-	changes.get_key_value_ptr_array(pairs.get());
+	auto visit_bucket = [&](const Vector<GameplayAbility *> *bucket) {
+		if (!bucket) {
+			return;
+		}
 
-	for (unsigned i = 0, n = changes.size(); i < n; i++) {
-		auto &&change = pairs[i]->data;
+		// The copy shares storage with the bucket, activations may change triggers while iterating.
+		const auto abilities = *bucket;
 
-		for (auto &&ability : active_abilities) {
-			ability->process_wait(WaitType::AttributeChanged, change.attribute);
+		for (auto ability : abilities) {
+			if (ability->trigger_visit != visit) {
+				ability->trigger_visit = visit;
+				function(ability);
+			}
 		}
+	};
+
+	// Wildcard tags are matched against every trigger.
+	if (tag.empty() || GameplayTagRegistry::is_wildcard(tag)) {
+		visit_bucket(&index.abilities);
+		return;
+	}
+
+	// Tags which were never interned can only match wildcard triggers.
+	auto registry = GameplayTagRegistry::get_singleton();
+	auto id = registry->find(tag);
+
+	if (id != GAMEPLAY_TAG_INVALID) {
+		visit_bucket(index.tags.getptr(id));
 
-		target->emit_signal(gameplay_attribute_changed, target, change.attribute, change.old_value);
+		for (auto parent = registry->get_parent(id); parent != GAMEPLAY_TAG_INVALID; parent = registry->get_parent(parent)) {
+			visit_bucket(index.descendants.getptr(parent));
+		}
 	}
+
+	visit_bucket(&index.patterns);
 }
 
 void GameplayAbilitySystem::add_active_ability(GameplayAbility *ability) {
@@ -1057,42 +1328,866 @@ void GameplayAbilitySystem::remove_active_ability(GameplayAbility *ability) {
 }
 
 void GameplayAbilitySystem::add_effect(GameplayAbilitySystem *source, const Ref<GameplayEffect> &effect, int64_t stacks, int64_t level, double normalised_level) {
-	auto effect_node = memnew(GameplayEffectNode);
-	effect_node->initialise(source, this, effect, level, normalised_level);
-	effect_node->add_stack(stacks);
-	call_deferred("add_child", effect_node);
+	auto index = allocate_effect();
+	auto &&record = get_effect_record(index);
+	record.source = source;
+	record.effect = effect;
+	record.spec = effect->get_spec();
+	record.level = level;
+	record.normalised_level = normalised_level;
+	add_effect_stack(index, stacks);
+
+	// All effects added until the next idle frame are started by a single deferred call.
+	if (pending_effects.empty()) {
+		defer_call("_start_pending_effects");
+	}
+
+	pending_effects.push_back(index);
 
-	for (auto ability : active_abilities) {
-		ability->process_wait(WaitType::EffectAdded, effect_node);
+	notify_effect_wait(WaitType::EffectAdded, effect);
+	notify_effect_wait(WaitType::EffectStackAdded, effect);
+}
+
+GameplayAbilitySystem::ActiveEffect &GameplayAbilitySystem::get_effect_record(int index) {
+	return effect_pages[index / effect_page_size][index % effect_page_size];
+}
+
+const GameplayAbilitySystem::ActiveEffect &GameplayAbilitySystem::get_effect_record(int index) const {
+	return effect_pages[index / effect_page_size][index % effect_page_size];
+}
+
+GameplayAbilitySystem::ActiveEffect *GameplayAbilitySystem::find_effect_record(const ActiveEffectEntry &entry) {
+	if (!entry.target) {
+		return nullptr;
 	}
-	for (auto ability : active_abilities) {
-		ability->process_wait(WaitType::EffectStackAdded, effect_node);
+
+	auto &&record = entry.target->get_effect_record(entry.effect_index);
+	return record.generation == entry.generation && !record.removed ? &record : nullptr;
+}
+
+GameplayEffectNode *GameplayAbilitySystem::get_effect_proxy(int index) const {
+	auto &&record = const_cast<GameplayAbilitySystem *>(this)->get_effect_record(index);
+
+	if (!record.proxy) {
+		record.proxy = memnew(GameplayEffectNode);
+		record.proxy->system = const_cast<GameplayAbilitySystem *>(this);
+		record.proxy->effect_index = index;
+		record.proxy->generation = record.generation;
 	}
+
+	return record.proxy;
 }
 
-double GameplayAbilitySystem::execute_magnitude(double magnitude, double current_value, int operation) {
-	ERR_FAIL_COND_V(operation < 0, -1.0);
-	ERR_FAIL_COND_V(operation > ModifierOperation::Override, -1.0);
+void GameplayAbilitySystem::index_effect(int index) {
+	auto &&record = get_effect_record(index);
+	auto &&tags = record.spec->get_effect_tags();
+	record.activation = effect_activations++;
 
-	switch (operation) {
-		case ModifierOperation::Add:
-			return current_value + magnitude;
-		case ModifierOperation::Subtract:
-			return current_value - magnitude;
-		case ModifierOperation::Multiply:
-			return current_value * magnitude;
-		case ModifierOperation::Divide:
-			return current_value / magnitude;
-		case ModifierOperation::Override:
-			return magnitude;
+	add_indexed_effect(effects_by_definition, record.effect->get_instance_id(), index);
+	add_indexed_effect(effects_by_name, record.spec->get_effect_name(), index);
+
+	for (int i = 0, n = tags->size(); i < n; i++) {
+		auto id = tags->get_tag_id(i);
+
+		if (id != GAMEPLAY_TAG_INVALID) {
+			record.indexed_tags.push_back(id);
+			add_indexed_effect(effects_by_tag, id, index);
+		}
 	}
+}
 
-	ERR_FAIL_V(-1.0);
+void GameplayAbilitySystem::unindex_effect(int index) {
+	auto &&record = get_effect_record(index);
+
+	remove_indexed_effect(effects_by_definition, record.effect->get_instance_id(), index);
+	remove_indexed_effect(effects_by_name, record.spec->get_effect_name(), index);
+
+	for (auto id : record.indexed_tags) {
+		remove_indexed_effect(effects_by_tag, id, index);
+	}
+
+	update_effect_cooldowns(index);
+	record.indexed_tags.clear();
 }
 
-void GameplayAbilitySystem::_bind_methods() {
+void GameplayAbilitySystem::update_cooldown(GameplayTagId id) {
+	CooldownEntry cooldown;
+	auto tracked = false;
+
+	if (auto effects = effects_by_tag.getptr(id)) {
+		for (auto index : *effects) {
+			auto &&record = get_effect_record(index);
+
+			if (record.effect->get_duration_type() != DurationType::HasDuration) {
+				continue;
+			}
+
+			tracked = true;
+
+			if (record.should_effect_process) {
+				cooldown.expiration = MAX(cooldown.expiration, record.expiration);
+			} else {
+				cooldown.paused_remaining = MAX(cooldown.paused_remaining, record.expiration - record.paused_at);
+			}
+		}
+	}
+
+	if (tracked) {
+		cooldowns.set(id, cooldown);
+	} else if (cooldowns.has(id)) {
+		cooldowns.erase(id);
+		ended_cooldowns.push_back(id);
+	}
+}
+
+void GameplayAbilitySystem::update_effect_cooldowns(int index) {
+	auto &&record = get_effect_record(index);
+
+	if (record.started && record.effect->get_duration_type() == DurationType::HasDuration) {
+		for (auto id : record.indexed_tags) {
+			update_cooldown(id);
+		}
+	}
+}
+
+void GameplayAbilitySystem::notify_ended_cooldowns() {
+	if (ended_cooldowns.empty()) {
+		return;
+	}
+
+	const auto ended = ended_cooldowns;
+	ended_cooldowns.clear();
+
+	for (auto ability : Vector<GameplayAbility *>(abilities)) {
+		auto &&cooldown_effect = ability->get_cooldown_effect();
+
+		if (cooldown_effect.is_null() || ability->get_remaining_cooldown() > 0) {
+			continue;
+		}
+
+		auto &&tags = cooldown_effect->get_effect_tags();
+		auto cooled_down = std::any_of(begin(ended), end(ended), [&tags](GameplayTagId id) {
+			return tags->has_tag_id(id);
+		});
+
+		if (cooled_down) {
+			emit_gameplay_signal(gameplay_ability_ready, this, ability);
+		}
+	}
+}
+
+void GameplayAbilitySystem::add_effect_immunities(int index) {
+	auto &&record = get_effect_record(index);
+	auto registry = GameplayTagRegistry::get_singleton();
+	record.granted_immunities = record.spec->get_application_immunity_tags()->get_tags();
+
+	for (int i = 0, n = record.granted_immunities.size(); i < n; i++) {
+		auto tag = record.granted_immunities[i];
+		auto id = registry->find(tag);
+
+		if (id == GAMEPLAY_TAG_INVALID) {
+			auto immunity = std::find_if(begin(immunity_patterns), end(immunity_patterns), [&tag](const ImmunityPattern &immunity) {
+				return immunity.tag == tag;
+			});
+
+			if (immunity != end(immunity_patterns)) {
+				immunity->count++;
+			} else {
+				ImmunityPattern pattern;
+				pattern.tag = tag;
+				pattern.pattern = GameplayTagPattern(tag);
+				pattern.count = 1;
+				immunity_patterns.push_back(pattern);
+			}
+		} else if (auto count = immunity_counts.getptr(id)) {
+			(*count)++;
+		} else {
+			immunity_counts.set(id, 1);
+			immunity_tags->append(tag);
+		}
+	}
+}
+
+void GameplayAbilitySystem::remove_effect_immunities(int index) {
+	auto &&record = get_effect_record(index);
+	auto registry = GameplayTagRegistry::get_singleton();
+
+	for (int i = 0, n = record.granted_immunities.size(); i < n; i++) {
+		auto tag = record.granted_immunities[i];
+		auto id = registry->find(tag);
+
+		if (id == GAMEPLAY_TAG_INVALID) {
+			for (int j = 0, m = immunity_patterns.size(); j < m; j++) {
+				if (immunity_patterns[j].tag == tag) {
+					if (--immunity_patterns.ptrw()[j].count == 0) {
+						immunity_patterns.remove(j);
+					}
+					break;
+				}
+			}
+		} else if (auto count = immunity_counts.getptr(id)) {
+			if (--(*count) == 0) {
+				immunity_counts.erase(id);
+				immunity_tags->remove_tag_id(id);
+			}
+		}
+	}
+
+	record.granted_immunities = PoolStringArray();
+}
+
+bool GameplayAbilitySystem::is_immune_to(const Ref<GameplayTagContainer> &tags) const {
+	if (tags->has_any(immunity_tags)) {
+		return true;
+	}
+
+	return std::any_of(begin(immunity_patterns), end(immunity_patterns), [&tags](const ImmunityPattern &immunity) {
+		return tags->has_tag_pattern(immunity.pattern);
+	});
+}
+
+Vector<int> GameplayAbilitySystem::find_effects_with_tag(const String &tag) const {
+	if (tag.empty() || GameplayTagRegistry::is_wildcard(tag)) {
+		Vector<int> result;
+
+		for (auto index : active_effects) {
+			if (get_effect_record(index).spec->get_effect_tags()->has_tag(tag)) {
+				result.push_back(index);
+			}
+		}
+
+		return result;
+	}
+
+	auto effects = effects_by_tag.getptr(GameplayTagRegistry::get_singleton()->find(tag));
+	return effects ? *effects : Vector<int>();
+}
+
+Vector<int> GameplayAbilitySystem::find_effects_with_tags(const Ref<GameplayTagContainer> &tags) const {
+	Vector<int> result;
+
+	for (int i = 0, n = tags->size(); i < n; i++) {
+		if (tags->get_tag_id(i) != GAMEPLAY_TAG_INVALID) {
+			continue;
+		}
+
+		// Wildcards can't be looked up, match every started effect instead.
+		for (auto index : active_effects) {
+			if (get_effect_record(index).spec->get_effect_tags()->has_any(tags)) {
+				result.push_back(index);
+			}
+		}
+
+		return result;
+	}
+
+	for (int i = 0, n = tags->size(); i < n; i++) {
+		if (auto effects = effects_by_tag.getptr(tags->get_tag_id(i))) {
+			for (auto index : *effects) {
+				result.push_back(index);
+			}
+		}
+	}
+
+	if (tags->size() > 1) {
+		// Merge the lists of multiple tags back into activation order.
+		auto first = result.ptrw();
+		auto last = first + result.size();
+
+		std::sort(first, last, [this](int a, int b) {
+			return get_effect_record(a).activation < get_effect_record(b).activation;
+		});
+		result.resize(std::unique(first, last) - first);
+	}
+
+	return result;
+}
+
+int GameplayAbilitySystem::allocate_effect() {
+	if (free_effects.empty()) {
+		auto page = memnew_arr(ActiveEffect, effect_page_size);
+		auto first = effect_pages.size() * effect_page_size;
+		effect_pages.push_back(page);
+
+		// Hand out lower indices first.
+		for (int i = effect_page_size - 1; i >= 0; i--) {
+			free_effects.push_back(first + i);
+		}
+	}
+
+	auto index = free_effects[free_effects.size() - 1];
+	free_effects.resize(free_effects.size() - 1);
+	return index;
+}
+
+void GameplayAbilitySystem::release_effect(int index) {
+	auto &&record = get_effect_record(index);
+
+	if (record.removed) {
+		return;
+	}
+
+	// Drop the stacking entry if it still refers to this record.
+	if (auto system = get_stacking_system(record)) {
+		auto effect_name = record.spec->get_effect_name();
+		auto entry = system->effect_stacking.getptr(effect_name);
+
+		if (entry && entry->target == this && entry->effect_index == index) {
+			system->effect_stacking.erase(effect_name);
+		}
+	}
+
+	if (record.started) {
+		unindex_effect(index);
+		remove_effect_immunities(index);
+	}
+
+	record.removed = true;
+	active_effects.erase(index);
+	pending_effects.erase(index);
+	dirty_effects.erase(index);
+	released_effects.push_back(index);
+}
+
+void GameplayAbilitySystem::recycle_effects() {
+	for (auto index : released_effects) {
+		auto &&record = get_effect_record(index);
+
+		if (record.proxy) {
+			record.proxy->system = nullptr;
+			record.proxy->defer_delete();
+		}
+
+		auto generation = record.generation + 1;
+		record = ActiveEffect();
+		record.generation = generation;
+		free_effects.push_back(index);
+	}
+
+	released_effects.clear();
+}
+
+GameplayAbilitySystem *GameplayAbilitySystem::get_stacking_system(const ActiveEffect &record) const {
+	switch (record.spec->get_stacking_type()) {
+		case StackingType::AggregateOnSource: {
+			return record.source;
+		} break;
+		case StackingType::AggregateOnTarget: {
+			return const_cast<GameplayAbilitySystem *>(this);
+		} break;
+		default: {
+			return nullptr;
+		} break;
+	}
+}
+
+int64_t GameplayAbilitySystem::get_effect_stacks(const ActiveEffect &record) const {
+	if (auto system = get_stacking_system(record)) {
+		auto entry = system->effect_stacking.getptr(record.spec->get_effect_name());
+		return entry ? entry->stacks : 1;
+	} else {
+		return record.internal_stacks;
+	}
+}
+
+void GameplayAbilitySystem::mark_effect_stacks(int index) {
+	auto &&record = get_effect_record(index);
+
+	if (!record.stack_applied) {
+		record.stack_applied = true;
+		dirty_effects.push_back(index);
+	}
+}
+
+void GameplayAbilitySystem::add_effect_stack(int index, int64_t value) {
+	auto &&record = get_effect_record(index);
+
+	if (value <= 0) {
+		if (value < 0) {
+			remove_effect_stack(index, -value);
+		}
+	} else if (auto system = get_stacking_system(record)) {
+		auto &&effect = record.effect;
+		auto effect_name = effect->get_effect_name();
+
+		if (auto entry = system->effect_stacking.getptr(effect_name)) {
+			auto current_stacks = entry->stacks;
+			auto stacks = current_stacks + value;
+			record.stack_overflow = stacks > effect->get_maximum_stacks();
+
+			if (!record.stack_applied) {
+				record.previous_stack = current_stacks;
+			}
+			if (record.stack_overflow) {
+				stacks = effect->get_maximum_stacks();
+			}
+
+			entry->stacks = stacks;
+		} else {
+			system->effect_stacking.set(effect_name, ActiveEffectEntry{ this, index, record.generation, record.level, value });
+		}
+
+		mark_effect_stacks(index);
+	}
+}
+
+void GameplayAbilitySystem::remove_effect_stack(int index, int64_t value) {
+	auto &&record = get_effect_record(index);
+
+	if (value <= 0) {
+		if (value < 0) {
+			add_effect_stack(index, -value);
+		}
+	} else if (auto system = get_stacking_system(record)) {
+		if (auto entry = system->effect_stacking.getptr(record.spec->get_effect_name())) {
+			auto current_stacks = entry->stacks;
+
+			if (!record.stack_applied) {
+				record.previous_stack = current_stacks;
+			}
+
+			entry->stacks = current_stacks - value;
+		} else {
+			WARN_PRINT("No effect present to remove.");
+		}
+
+		mark_effect_stacks(index);
+	} else {
+		record.internal_stacks = 0;
+		mark_effect_stacks(index);
+	}
+}
+
+void GameplayAbilitySystem::remove_active_effect(int index, int64_t stacks, int64_t level) {
+	auto &&record = get_effect_record(index);
+	auto effect = record.effect;
+
+	if (record.level > level) {
+		emit_gameplay_signal(gameplay_effect_removal_failed, this, effect);
+	} else {
+		remove_effect_stack(index, stacks);
+		notify_effect_wait(WaitType::EffectRemoved, effect);
+	}
+}
+
+double GameplayAbilitySystem::calculate_effect_duration(const ActiveEffect &record) const {
+	auto duration_magnitude = record.effect->get_duration_magnitude();
+
+	if (duration_magnitude.is_valid()) {
+		return duration_magnitude->calculate_magnitude(record.source, this, record.effect, record.level, record.normalised_level);
+	} else {
+		return 0;
+	}
+}
+
+double GameplayAbilitySystem::calculate_effect_period(const ActiveEffect &record) const {
+	auto period_magnitude = record.effect->get_period();
+
+	if (period_magnitude.is_valid()) {
+		return period_magnitude->calculate_magnitude(record.source, this, record.effect, record.level, record.normalised_level);
+	} else {
+		return 0;
+	}
+}
+
+double GameplayAbilitySystem::get_remaining_duration(const ActiveEffect &record) const {
+	if (record.effect->get_duration_type() != DurationType::HasDuration) {
+		return 0;
+	}
+
+	auto now = record.should_effect_process ? effect_clock : record.paused_at;
+	return MAX(record.expiration - now, 0.0);
+}
+
+void GameplayAbilitySystem::schedule_effect(int index, double time, bool period) {
+	effect_deadlines.push_back(EffectDeadline{ time, index, get_effect_record(index).generation, period });
+	std::push_heap(begin(effect_deadlines), end(effect_deadlines), std::greater<EffectDeadline>());
+
+	// Long effects refreshed often would otherwise pile up deadlines which only get dropped once they're due.
+	if (effect_deadlines.size() > effect_deadline_limit) {
+		compact_effect_deadlines();
+	}
+}
+
+bool GameplayAbilitySystem::is_deadline_live(const EffectDeadline &deadline) const {
+	auto &&record = get_effect_record(deadline.effect_index);
+
+	if (record.generation != deadline.generation || record.removed) {
+		return false;
+	}
+
+	return (deadline.period ? record.next_period : record.expiration) == deadline.time;
+}
+
+void GameplayAbilitySystem::compact_effect_deadlines() {
+	auto data = effect_deadlines.ptrw();
+	auto count = 0;
+
+	for (int i = 0, n = effect_deadlines.size(); i < n; i++) {
+		if (is_deadline_live(data[i])) {
+			data[count++] = data[i];
+		}
+	}
+
+	effect_deadlines.resize(count);
+	std::make_heap(begin(effect_deadlines), end(effect_deadlines), std::greater<EffectDeadline>());
+	effect_deadline_limit = MAX(count * 2, 64);
+}
+
+void GameplayAbilitySystem::schedule_effect_deadlines(int index) {
+	auto &&record = get_effect_record(index);
+	auto &&effect = record.effect;
+
+	if (effect->get_duration_type() == DurationType::HasDuration) {
+		schedule_effect(index, record.expiration, false);
+	}
+	if (effect->get_period().is_valid()) {
+		schedule_effect(index, record.next_period, true);
+	}
+}
+
+void GameplayAbilitySystem::refresh_effect_duration(int index) {
+	auto &&record = get_effect_record(index);
+	record.expiration = effect_clock + calculate_effect_duration(record);
+
+	if (record.effect->get_duration_type() == DurationType::HasDuration) {
+		schedule_effect(index, record.expiration, false);
+	}
+
+	update_effect_cooldowns(index);
+}
+
+void GameplayAbilitySystem::reset_effect_period(int index) {
+	auto &&record = get_effect_record(index);
+
+	if (record.effect->get_period().is_valid()) {
+		record.next_period = effect_clock + calculate_effect_period(record);
+		schedule_effect(index, record.next_period, true);
+	}
+}
+
+void GameplayAbilitySystem::set_effect_processing(int index, bool value) {
+	auto &&record = get_effect_record(index);
+
+	if (record.should_effect_process == value) {
+		return;
+	}
+
+	record.should_effect_process = value;
+
+	if (value) {
+		// Shift deadlines by the time spent paused.
+		auto paused = effect_clock - record.paused_at;
+		record.expiration += paused;
+		record.next_period += paused;
+
+		if (record.started) {
+			schedule_effect_deadlines(index);
+		}
+	} else {
+		record.paused_at = effect_clock;
+	}
+
+	update_effect_cooldowns(index);
+}
+
+void GameplayAbilitySystem::apply_effects_from(const ActiveEffect &record, const Array &effects) {
+	if (!record.removed) {
+		apply_effects(record.source, effects, 1, record.level, record.normalised_level);
+	}
+}
+
+void GameplayAbilitySystem::_start_pending_effects() {
+	const auto effects = pending_effects;
+	pending_effects.clear();
+
+	for (auto index : effects) {
+		if (!get_effect_record(index).removed) {
+			start_effect(index);
+		}
+	}
+}
+
+void GameplayAbilitySystem::start_effect(int index) {
+	auto &&record = get_effect_record(index);
+	auto &&effect = record.effect;
+
+	if (effect->get_duration_type() == DurationType::HasDuration) {
+		ERR_FAIL_COND(effect->get_duration_magnitude().is_null());
+	}
+
+	// Tags
+	add_tags(effect->get_target_tags());
+
+	// Abilities
+	for (Ref<PackedScene> packed_scene : effect->get_granted_abilities()) {
+		if (auto node = packed_scene->instance()) {
+			if (auto ability = dynamic_cast<GameplayAbility *>(node)) {
+				record.granted_abilities.push_back(ability);
+				add_ability(ability);
+			}
+		}
+	}
+
+	// Period execution, lasting effects without period aggregate their modifiers right away.
+	if (effect->get_period().is_valid() && effect->get_execute_period_on_application()) {
+		execute_effect(index);
+	} else if (record.spec->is_aggregated()) {
+		execute_effect(index);
+	}
+
+	// Deadlines
+	record.expiration = effect_clock + calculate_effect_duration(record);
+	record.next_period = effect_clock;
+
+	if (effect->get_period().is_valid()) {
+		record.next_period += calculate_effect_period(record);
+	}
+	if (!record.should_effect_process) {
+		record.paused_at = effect_clock;
+	}
+
+	schedule_effect_deadlines(index);
+
+	record.started = true;
+	active_effects.push_back(index);
+	index_effect(index);
+	update_effect_cooldowns(index);
+	add_effect_immunities(index);
+	emit_gameplay_signal(gameplay_effect_activated, this, effect);
+}
+
+void GameplayAbilitySystem::end_effect(int index, bool cancelled) {
+	auto &&record = get_effect_record(index);
+	auto effect = record.effect;
+
+	// Abilities
+	for (auto ability : record.granted_abilities) {
+		remove_ability(ability);
+	}
+
+	// Expiration Effects
+	if (cancelled) {
+		apply_effects_from(record, effect->get_premature_expiration_effects());
+	} else {
+		apply_effects_from(record, effect->get_normal_expiration_effects());
+	}
+
+	// Tags
+	remove_tags(effect->get_target_tags());
+
+	// Modifiers
+	remove_modifiers(index);
+
+	// Reset Duration
+	record.expiration = effect_clock;
+
+	// Signal
+	emit_gameplay_signal(gameplay_effect_ended, this, effect, cancelled);
+
+	// Purge
+	release_effect(index);
+}
+
+void GameplayAbilitySystem::advance_effect(int index, double delta) {
+	auto &&record = get_effect_record(index);
+
+	if (record.started && !record.removed) {
+		record.expiration -= delta;
+		record.next_period -= delta;
+		schedule_effect_deadlines(index);
+		update_effect_cooldowns(index);
+	}
+}
+
+void GameplayAbilitySystem::expire_effect(int index) {
+	auto &&record = get_effect_record(index);
+	auto &&effect = record.effect;
+
+	switch (effect->get_stack_expiration()) {
+		case StackExpiration::ClearStack: {
+			apply_effects_from(record, effect->get_normal_expiration_effects());
+			end_effect(index, false);
+		} break;
+		case StackExpiration::RefreshDuration: {
+			refresh_effect_duration(index);
+			record.refreshed_at = effect_clock;
+		} break;
+		case StackExpiration::RemoveSingleStackAndRefreshDuration: {
+			refresh_effect_duration(index);
+			record.refreshed_at = effect_clock;
+			remove_effect_stack(index, 1);
+		} break;
+		default: {
+		} break;
+	}
+}
+
+void GameplayAbilitySystem::process_effect_periods(int index) {
+	auto &&record = get_effect_record(index);
+	auto threshold = calculate_effect_period(record);
+	auto until = effect_clock;
+	int64_t ticks = 0;
+
+	// Periods after the expiration of an effect with duration never happen.
+	if (record.effect->get_duration_type() == DurationType::HasDuration) {
+		until = MIN(until, record.expiration);
+	}
+
+	// Catch up on every period which elapsed since the last update.
+	do {
+		record.next_period += threshold;
+		ticks++;
+	} while (threshold > 0 && record.next_period <= until);
+
+	schedule_effect(index, record.next_period, true);
+
+	if (ticks > 1 && record.spec->is_linear()) {
+		execute_effect(index, ticks);
+	} else {
+		for (int64_t i = 0; i < ticks && !record.removed; i++) {
+			execute_effect(index);
+		}
+	}
+}
+
+void GameplayAbilitySystem::process_effect_stacks(int index) {
+	auto &&record = get_effect_record(index);
+	auto &&effect = record.effect;
+	auto stacks = get_effect_stacks(record);
+
+	if (stacks <= 0) {
+		if (effect->get_duration_type() == DurationType::HasDuration) {
+			auto duration_refreshed = record.refreshed_at == effect_clock;
+			end_effect(index, !duration_refreshed && get_remaining_duration(record) > 0);
+		} else {
+			end_effect(index, true);
+		}
+		return;
+	} else if (record.previous_stack != stacks) {
+		if (record.previous_stack < stacks) {
+			execute_effect(index);
+		} else if (record.spec->is_aggregated()) {
+			remove_modifiers(index, stacks);
+		}
+		if (effect->get_duration_refresh() == StackDurationRefresh::OnApplication) {
+			refresh_effect_duration(index);
+		}
+		if (effect->get_period_reset() == StackPeriodReset::OnApplication) {
+			reset_effect_period(index);
+		}
+	}
+	if (record.stack_overflow) {
+		apply_effects_from(record, effect->get_overflow_effects());
+
+		if (effect->get_clear_overflow_stack()) {
+			remove_effect_stack(index, get_effect_stacks(record));
+		}
+	}
+
+	record.stack_overflow = false;
+	record.stack_applied = false;
+}
+
+void GameplayAbilitySystem::process_effects(double delta) {
+	effect_clock += delta;
+
+	// Collect due deadlines first, deadlines scheduled while processing fire with the next update at the earliest.
+	// Elapsed periods are caught up on by the period deadline itself.
+	Vector<EffectDeadline> deadlines;
+
+	while (!effect_deadlines.empty() && effect_deadlines[0].time <= effect_clock) {
+		std::pop_heap(begin(effect_deadlines), end(effect_deadlines), std::greater<EffectDeadline>());
+		deadlines.push_back(effect_deadlines[effect_deadlines.size() - 1]);
+		effect_deadlines.resize(effect_deadlines.size() - 1);
+	}
+
+	for (auto &&deadline : deadlines) {
+		auto &&record = get_effect_record(deadline.effect_index);
+
+		// Skip deadlines which were rescheduled or belong to an ended or paused effect.
+		if (!is_deadline_live(deadline) || !record.should_effect_process) {
+			continue;
+		}
+		if (deadline.period) {
+			process_effect_periods(deadline.effect_index);
+		} else {
+			expire_effect(deadline.effect_index);
+		}
+	}
+
+	// Stack changes of pending or paused effects are kept until they process again.
+	const auto effects = dirty_effects;
+	dirty_effects.clear();
+
+	for (auto index : effects) {
+		auto &&record = get_effect_record(index);
+
+		if (record.removed || !record.stack_applied) {
+			continue;
+		} else if (!record.started || !record.should_effect_process) {
+			dirty_effects.push_back(index);
+		} else {
+			process_effect_stacks(index);
+		}
+	}
+
+	recycle_effects();
+	notify_ended_cooldowns();
+}
+
+void GameplayAbilitySystem::process_abilities(double delta) {
+	// Inactive abilities have nothing to process, abilities may end while iterating.
+	const auto processed = active_abilities;
+
+	for (auto ability : processed) {
+		if (!ability->is_queued_for_deletion() && ability->should_ability_process) {
+			ability->ability_process(delta);
+		}
+	}
+}
+
+void GameplayAbilitySystem::process_ability_input() {
+	const auto polled = abilities;
+
+	for (auto ability : polled) {
+		if (!ability->is_queued_for_deletion() && ability->should_ability_input) {
+			ability->ability_input();
+		}
+	}
+}
+
+double GameplayAbilitySystem::execute_magnitude(double magnitude, double current_value, int operation) {
+	ERR_FAIL_COND_V(operation < 0, -1.0);
+	ERR_FAIL_COND_V(operation > ModifierOperation::Override, -1.0);
+
+	switch (operation) {
+		case ModifierOperation::Add:
+			return current_value + magnitude;
+		case ModifierOperation::Subtract:
+			return current_value - magnitude;
+		case ModifierOperation::Multiply:
+			return current_value * magnitude;
+		case ModifierOperation::Divide:
+			return current_value / magnitude;
+		case ModifierOperation::Override:
+			return magnitude;
+	}
+
+	ERR_FAIL_V(-1.0);
+}
+
+void GameplayAbilitySystem::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("_start_pending_effects"), &GameplayAbilitySystem::_start_pending_effects);
+	ClassDB::bind_method(D_METHOD("set_world_processing", "value"), &GameplayAbilitySystem::set_world_processing);
+	ClassDB::bind_method(D_METHOD("is_world_processing"), &GameplayAbilitySystem::is_world_processing);
+	ClassDB::bind_method(D_METHOD("set_random_seed", "value"), &GameplayAbilitySystem::set_random_seed);
+	ClassDB::bind_method(D_METHOD("get_random_seed"), &GameplayAbilitySystem::get_random_seed);
+	ClassDB::bind_method(D_METHOD("set_random_sequence", "value"), &GameplayAbilitySystem::set_random_sequence);
+	ClassDB::bind_method(D_METHOD("get_random_sequence"), &GameplayAbilitySystem::get_random_sequence);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "world_processing"), "set_world_processing", "is_world_processing");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "random_seed"), "set_random_seed", "get_random_seed");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "random_sequence"), "set_random_sequence", "get_random_sequence");
 }
 
-std::random_device GameplayAbilitySystem::rdevice;
-std::default_random_engine GameplayAbilitySystem::rengine = std::default_random_engine(rdevice());
-std::uniform_real_distribution<double> GameplayAbilitySystem::rgenerator;
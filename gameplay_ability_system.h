@@ -1,12 +1,16 @@
 #pragma once
 
+#include "gameplay_ability.h"
+#include "gameplay_attribute.h"
+#include "gameplay_effect.h"
 #include "gameplay_node.h"
+#include "gameplay_tags.h"
 
 #include <core/hash_map.h>
 #include <core/vector.h>
 
+#include <atomic>
 #include <cmath>
-#include <random>
 
 class GameplayEffect;
 class GameplayEffectCue;
@@ -15,7 +19,6 @@ class GameplayAbility;
 class GameplayAttribute;
 class GameplayAttributeData;
 class GameplayAttributeSet;
-class GameplayTagContainer;
 class GameplayAbilitySystem;
 
 namespace UpdateAttributeOperation {
@@ -40,6 +43,7 @@ public:
 
 	void set_event_tag(const String &value);
 	const String &get_event_tag() const;
+	const GameplayTagPattern &get_event_pattern() const;
 
 	void add_event_target(Node *target);
 	const Array &get_event_targets() const;
@@ -47,21 +51,27 @@ public:
 private:
 	/** Tag identifying this event. */
 	String event_tag;
+	/** Compiled event tag. */
+	GameplayTagPattern event_pattern;
 	/** Event target is the one being targeted by the event. */
 	Array event_targets;
 
 	static void _bind_methods();
 };
 
+/**
+ * Script facing proxy of an active effect, active effects themselves are pooled records of their target system.
+ * Proxies are created on demand and outlive their effect only as stale, inert objects until freed.
+ */
 class GAMEPLAY_ABILITIES_API GameplayEffectNode : public GameplayNode {
 	GDCLASS(GameplayEffectNode, GameplayNode);
 	OBJ_CATEGORY("GameplayAbilities");
 
+	friend class GameplayAbilitySystem;
+
 public:
 	virtual ~GameplayEffectNode() = default;
 
-	void initialise(GameplayAbilitySystem *source, GameplayAbilitySystem *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level);
-
 	Node *get_source() const;
 	Node *get_target() const;
 
@@ -74,38 +84,18 @@ public:
 	void add_stack(int64_t value);
 	void remove_stack(int64_t value);
 
+	/** Advances the timers of this effect, expirations and periods due fire with the next update of the system. */
 	void effect_process(double delta);
 	void set_effect_process(bool value);
 
-protected:
-	void _notification(int notification);
+	/** Returns true while the proxied effect is still active. */
+	bool is_valid() const;
 
 private:
-	GameplayAbilitySystem *source = nullptr;
-	GameplayAbilitySystem *target = nullptr;
-	Ref<GameplayEffect> effect;
-	int64_t level = 1;
-	int64_t previous_stack = 1;
-	double normalised_level = 1;
-	double duration = 0;
-	double period = 0;
-
-	bool stack_overflow = false;
-	bool stack_applied = false;
-	bool should_effect_process = true;
-	int64_t internal_stacks = 1;
-
-	Vector<GameplayAbility *> granted_abilities;
-
-	double calculate_duration() const;
-	double calculate_period_threshold() const;
-	void apply_effect(const Ref<GameplayEffect> &effect);
-	void apply_effects(const Array &effects);
-	void execute_effect();
-	GameplayAbilitySystem *get_stacking_system() const;
-
-	void start_effect();
-	void end_effect(bool cancelled);
+	/** Target system owning the effect record, null once the record got recycled. */
+	GameplayAbilitySystem *system = nullptr;
+	int effect_index = -1;
+	uint32_t generation = 0;
 
 	static void _bind_methods();
 };
@@ -135,10 +125,11 @@ class GAMEPLAY_ABILITIES_API GameplayAbilitySystem : public GameplayNode {
 
 	friend class GameplayEffectNode;
 	friend class GameplayAbility;
+	friend class GameplayWorld;
 
 public:
 	GameplayAbilitySystem();
-	virtual ~GameplayAbilitySystem() = default;
+	virtual ~GameplayAbilitySystem();
 
 	/** Gets all currently active and owned tags. */
 	const Ref<GameplayAttributeSet> &get_attributes() const;
@@ -161,6 +152,10 @@ public:
 	Array query_active_effects(const Ref<GameplayTagContainer> &tags) const;
 	/** Gets remaining duration left on active effect. */
 	double get_remaining_effect_duration(const Ref<GameplayEffect> &effect) const;
+	/** Gets the longest remaining duration of active effects with at least one of the given tags. */
+	double get_longest_remaining_duration(const Ref<GameplayTagContainer> &tags) const;
+	/** Gets the remaining cooldown of the given cooldown tags from the cooldown table. */
+	double get_remaining_cooldown(const Ref<GameplayTagContainer> &tags) const;
 
 	/** Returns true if this ability system triggered any abilities via the given event. */
 	bool handle_event(const Ref<GameplayEvent> &event);
@@ -175,10 +170,10 @@ public:
 	/** Updates base value of attribute. */
 	bool update_base_attribute(const StringName &name, double value, UpdateAttributeOperation::Type operation = UpdateAttributeOperation::None);
 
-	/** Adds tags. */
+	/** Adds tags, each tag is reference counted and only reported once it gets added for the first time. */
 	void add_tag(const String &tag);
 	void add_tags(const Ref<GameplayTagContainer> &tags);
-	/** Removes tags. */
+	/** Removes tags, wildcards remove a single reference from every matching tag. */
 	void remove_tag(const String &tag);
 	void remove_tags(const Ref<GameplayTagContainer> &tags);
 	/** Adds a single ability to this instance. */
@@ -215,6 +210,15 @@ public:
 
 	void set_attribute_set(const Ref<GameplayAttributeSet> &value);
 	const Ref<GameplayAttributeSet> &get_attribute_set() const;
+	/** Seeds the stream infliction chances are rolled from and restarts it, equal seeds yield equal rolls. */
+	void set_random_seed(uint64_t value);
+	uint64_t get_random_seed() const;
+	/** Amount of rolls drawn so far, restoring it continues a stream e.g. for replays. */
+	void set_random_sequence(uint64_t value);
+	uint64_t get_random_sequence() const;
+	/** Ticks this system from the GameplayWorld instead of the process notifications of its nodes. */
+	void set_world_processing(bool value);
+	bool is_world_processing() const;
 
 	/** Targeting */
 
@@ -227,29 +231,273 @@ protected:
 	void _notification(int notification);
 
 private:
+	/** Aggregated execution of an effect, removed again once its stacks are gone. */
+	struct AppliedExecution {
+		/** Offset into applied_modifiers at which the execution starts. */
+		int offset = 0;
+		/** Stack count the execution has been applied for. */
+		int64_t stacks = 0;
+	};
+
+	/** State of a single active effect, pooled by its target system. */
+	struct ActiveEffect {
+		GameplayAbilitySystem *source = nullptr;
+		Ref<GameplayEffect> effect;
+		/** Compiled effect at the time of application. */
+		Ref<GameplayEffectSpec> spec;
+		int64_t level = 1;
+		int64_t previous_stack = 1;
+		double normalised_level = 1;
+		/** Clock time at which the duration runs out. */
+		double expiration = 0;
+		/** Clock time of the next period execution. */
+		double next_period = 0;
+		/** Clock time at which processing got disabled. */
+		double paused_at = 0;
+		/** Clock time at which the duration got refreshed last. */
+		double refreshed_at = -1;
+		int64_t internal_stacks = 1;
+		/** Incremented every time the record gets recycled. */
+		uint32_t generation = 0;
+		/** Order in which the record started, keeps index lookups in activation order. */
+		uint64_t activation = 0;
+
+		/** Set once the effect ended, the record gets recycled after processing. */
+		bool removed = false;
+		/** Set once the effect started, stack changes of pending effects wait until then. */
+		bool started = false;
+		bool stack_overflow = false;
+		bool stack_applied = false;
+		bool should_effect_process = true;
+
+		Vector<GameplayAbility *> granted_abilities;
+		/** Aggregated modifiers of this effect, removed again once it ends. */
+		Vector<GameplayAttributeModifier> applied_modifiers;
+		/** Executions whose modifiers are part of applied_modifiers, in order of application. */
+		Vector<AppliedExecution> applied_executions;
+		/** Interned effect tags the record got indexed with once started. */
+		Vector<GameplayTagId> indexed_tags;
+		/** Application immunity tags the record added to the immunity union once started. */
+		PoolStringArray granted_immunities;
+		/** Lazily created script proxy. */
+		GameplayEffectNode *proxy = nullptr;
+	};
+
+	/** Stacking state of an effect, the effect itself may live in the pool of another system. */
 	struct ActiveEffectEntry {
-		GameplayEffectNode *effect_node = nullptr;
+		GameplayAbilitySystem *target = nullptr;
+		int effect_index = -1;
+		uint32_t generation = 0;
 		int64_t level = 1;
 		int64_t stacks = 1;
 	};
 
+	/** Scheduled expiration or period execution of an effect record. */
+	struct EffectDeadline {
+		double time = 0;
+		int effect_index = -1;
+		uint32_t generation = 0;
+		bool period = false;
+
+		/** Periods due at the expiration of their effect are processed before it. */
+		bool operator>(const EffectDeadline &other) const {
+			return time > other.time || (time == other.time && !period && other.period);
+		}
+	};
+
+	struct AttributeChange {
+		GameplayAttributeIndex index = GAMEPLAY_ATTRIBUTE_INVALID;
+		double old_value = 0;
+	};
+
+	/** Wildcard application immunity, matched against the effect tags of every application. */
+	struct ImmunityPattern {
+		String tag;
+		GameplayTagPattern pattern;
+		int64_t count = 0;
+	};
+
+	/** Longest remaining duration of started effects with a duration sharing an effect tag. */
+	struct CooldownEntry {
+		/** Latest expiration of processing effects on the effect clock. */
+		double expiration = 0;
+		/** Longest remaining duration of paused effects, which doesn't elapse. */
+		double paused_remaining = 0;
+	};
+
+	/** Abilities indexed by their trigger tags for a single trigger type. */
+	struct TriggerIndex {
+		/** Abilities triggered by an exact tag. */
+		HashMap<GameplayTagId, Vector<GameplayAbility *> > tags;
+		/** Abilities triggered by every child of a tag, e.g. A.B.* */
+		HashMap<GameplayTagId, Vector<GameplayAbility *> > descendants;
+		/** Abilities triggered by any other wildcard. */
+		Vector<GameplayAbility *> patterns;
+		/** Every ability with at least one trigger of this type. */
+		Vector<GameplayAbility *> abilities;
+	};
+
 	HashMap<StringName, ActiveEffectEntry> effect_stacking;
+	TriggerIndex trigger_index[AbilityTrigger::OwnedTagRemoved + 1];
+	/** Abilities waiting on a specific key, keyed by wait type in the upper and key in the lower 32 bits. */
+	HashMap<uint64_t, Vector<GameplayAbility *> > wait_subscriptions;
+	/** Abilities waiting on an event matching a wildcard. */
+	Vector<GameplayAbility *> wait_event_patterns;
+	/** Reference count per active tag, tags only present in active_tags count as one. */
+	HashMap<GameplayTagId, int64_t> tag_counts;
 
 	Array targets;
 	Ref<GameplayAttributeSet> attributes;
 	Ref<GameplayTagContainer> persistent_cues = make_reference<GameplayTagContainer>();
 	Ref<GameplayTagContainer> active_tags = make_reference<GameplayTagContainer>();
+	/** Union of the interned application immunity tags of all started effects. */
+	Ref<GameplayTagContainer> immunity_tags = make_reference<GameplayTagContainer>();
+	/** Amount of started effects granting each tag in immunity_tags. */
+	HashMap<GameplayTagId, int64_t> immunity_counts;
+	/** Application immunities which can't be interned. */
+	Vector<ImmunityPattern> immunity_patterns;
 
 	Vector<GameplayAbility *> abilities;
 	Vector<GameplayAbility *> active_abilities;
-	Vector<GameplayEffectNode *> active_effects;
-
-	static std::random_device rdevice;
-	static std::default_random_engine rengine;
-	static std::uniform_real_distribution<double> rgenerator;
 
-	void execute_effect(GameplayEffectNode *node);
-	void apply_modifiers(GameplayEffectNode *node, const Array &modifiers);
+	/** Effect records in pages of fixed size, records never move once allocated. */
+	Vector<ActiveEffect *> effect_pages;
+	/** Recycled records ready for reuse. */
+	Vector<int> free_effects;
+	/** Ended records which get recycled after processing. */
+	Vector<int> released_effects;
+	/** Added effects which start with the next deferred call. */
+	Vector<int> pending_effects;
+	/** Started effects in order of activation. */
+	Vector<int> active_effects;
+	/** Records with stack changes which are processed with the next update. */
+	Vector<int> dirty_effects;
+	/** Started effects by the instance id of their effect, in order of activation. */
+	HashMap<ObjectID, Vector<int> > effects_by_definition;
+	/** Started effects by effect name, in order of activation. */
+	HashMap<StringName, Vector<int> > effects_by_name;
+	/** Started effects by each of their interned effect tags, in order of activation. */
+	HashMap<GameplayTagId, Vector<int> > effects_by_tag;
+	/** Cooldown table by interned effect tag, updated whenever the deadlines of an effect with a duration change. */
+	HashMap<GameplayTagId, CooldownEntry> cooldowns;
+	/** Tags whose cooldown ended since the last update. */
+	Vector<GameplayTagId> ended_cooldowns;
+	/** Amount of trigger lookups so far. */
+	uint64_t trigger_visits = 0;
+	/** Amount of effects started so far. */
+	uint64_t effect_activations = 0;
+	/** Min-heap of effect deadlines, stale entries are skipped once popped or dropped when the heap gets compacted. */
+	Vector<EffectDeadline> effect_deadlines;
+	/** Heap size at which stale deadlines are dropped, twice the live deadlines after the last compaction. */
+	int effect_deadline_limit = 64;
+	/** Time advanced by every update, effect deadlines are absolute times on this clock. */
+	double effect_clock = 0;
+
+	/** Seed of the stream infliction chances are rolled from. */
+	uint64_t random_seed = 0;
+	/** Amount of rolls drawn from the stream, advanced atomically so concurrent rolls never share a draw. */
+	std::atomic<uint64_t> random_sequence{ 0 };
+
+	/** True if this system and its abilities are ticked by the GameplayWorld. */
+	bool world_processing = false;
+	/** Slot of this system in the GameplayWorld or -1 if it isn't registered. */
+	int world_index = -1;
+
+	/** Draws the next uniform value in [0, 1) from the stream of this system. */
+	double roll_random();
+
+	ActiveEffect &get_effect_record(int index);
+	const ActiveEffect &get_effect_record(int index) const;
+	/** Returns the record referenced by a stacking entry or null if it already ended. */
+	static ActiveEffect *find_effect_record(const ActiveEffectEntry &entry);
+	GameplayEffectNode *get_effect_proxy(int index) const;
+	/** Adds a started record to the effect indexes. */
+	void index_effect(int index);
+	/** Removes an ended record from the effect indexes. */
+	void unindex_effect(int index);
+	/** Recomputes the cooldown entry of a tag from the started effects indexed under it. */
+	void update_cooldown(GameplayTagId id);
+	/** Recomputes the cooldown entries of the tags of a started record with a duration. */
+	void update_effect_cooldowns(int index);
+	/** Emits gameplay_ability_ready once for abilities whose cooldown ended since the last update. */
+	void notify_ended_cooldowns();
+	/** Adds the application immunity tags of a started record to the immunity union. */
+	void add_effect_immunities(int index);
+	/** Removes the application immunity tags of an ended record from the immunity union. */
+	void remove_effect_immunities(int index);
+	/** Returns true if started effects grant immunity against any of the given effect tags. */
+	bool is_immune_to(const Ref<GameplayTagContainer> &tags) const;
+	/** Returns started records with the given effect tag in order of activation. */
+	Vector<int> find_effects_with_tag(const String &tag) const;
+	/** Returns started records with at least one of the given effect tags in order of activation. */
+	Vector<int> find_effects_with_tags(const Ref<GameplayTagContainer> &tags) const;
+	int allocate_effect();
+	void release_effect(int index);
+	void recycle_effects();
+
+	GameplayAbilitySystem *get_stacking_system(const ActiveEffect &record) const;
+	int64_t get_effect_stacks(const ActiveEffect &record) const;
+	/** Flags a stack change of a record, processed with the next update. */
+	void mark_effect_stacks(int index);
+	void add_effect_stack(int index, int64_t value);
+	void remove_effect_stack(int index, int64_t value);
+	void remove_active_effect(int index, int64_t stacks, int64_t level);
+	double calculate_effect_duration(const ActiveEffect &record) const;
+	double calculate_effect_period(const ActiveEffect &record) const;
+	double get_remaining_duration(const ActiveEffect &record) const;
+	void schedule_effect(int index, double time, bool period);
+	/** Returns true if deadline is still the current expiration or period of its record. */
+	bool is_deadline_live(const EffectDeadline &deadline) const;
+	/** Drops stale deadlines left behind by refreshed, reset or resumed effects and restores the heap. */
+	void compact_effect_deadlines();
+	/** Schedules the expiration and next period of a record from its current deadlines. */
+	void schedule_effect_deadlines(int index);
+	void refresh_effect_duration(int index);
+	void reset_effect_period(int index);
+	void set_effect_processing(int index, bool value);
+	void apply_effects_from(const ActiveEffect &record, const Array &effects);
+
+	void _start_pending_effects();
+	void start_effect(int index);
+	void end_effect(int index, bool cancelled);
+	void advance_effect(int index, double delta);
+	void expire_effect(int index);
+	void process_effect_periods(int index);
+	void process_effect_stacks(int index);
+	void process_effects(double delta);
+	/** Processes waits and tag requirements of active abilities. */
+	void process_abilities(double delta);
+	/** Polls input actions of abilities. */
+	void process_ability_input();
+
+	/** Executes an instant effect on the stack without going through the effect pool. */
+	void execute_instant_effect(GameplayAbilitySystem *source, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level);
+	void execute_effect(int index, int64_t ticks = 1);
+	/** Executes a record, index is -1 for instant effects which are not pooled. Ticks > 1 are only valid for linear effects. */
+	void execute_effect(ActiveEffect &record, int index, int64_t ticks = 1);
+	/** Applies modifiers, linear modifiers of several period ticks are applied at once. */
+	void apply_modifiers(ActiveEffect &record, const Vector<GameplayEffectSpec::Modifier> &modifiers, int64_t ticks = 1);
+	/** Removes aggregated modifiers of all executions not covered by the remaining stacks of an effect. */
+	void remove_modifiers(int index, int64_t stacks = 0);
+	void track_attribute_change(Vector<AttributeChange> &changes, GameplayAttributeIndex index) const;
+	void notify_attribute_changes(const Vector<AttributeChange> &changes);
+
+	void index_triggers(GameplayAbility *ability);
+	void unindex_triggers(GameplayAbility *ability);
+	/** Calls function once for every ability with a trigger of the given type which may match tag. */
+	template <class Function>
+	void for_each_triggered_ability(const String &tag, AbilityTrigger::Type trigger_type, Function &&function);
+
+	void subscribe_wait(GameplayAbility *ability);
+	void unsubscribe_waits(GameplayAbility *ability);
+	void notify_wait(WaitType::Type wait_type, uint32_t key, const Variant &data);
+	void notify_effect_wait(WaitType::Type wait_type, const Ref<GameplayEffect> &effect);
+	void notify_event_wait(const String &event_tag);
+
+	bool increment_tag(const String &tag);
+	void decrement_tag(const String &tag, Vector<String> &removed_tags);
+	void notify_tag_added(const String &tag);
+	void notify_tag_removed(const String &tag);
 
 	void add_active_ability(GameplayAbility *ability);
 	void remove_active_ability(GameplayAbility *ability);
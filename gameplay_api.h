@@ -362,6 +362,21 @@ inline StringName operator"" _n(const char *str, std::size_t size) {
 	return StringName(str);
 }
 
+/** Stateless counter based random numbers, the n-th draw of a stream is SplitMix64 of seed + n * gamma. */
+namespace GameplayRandom {
+/** SplitMix64 finaliser. */
+inline uint64_t mix(uint64_t value) {
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return value ^ (value >> 31);
+}
+
+/** Uniform value in [0, 1) for the given draw of the stream identified by seed. */
+inline double unit(uint64_t seed, uint64_t counter) {
+	return (mix(seed + (counter + 1) * 0x9E3779B97F4A7C15ull) >> 11) * (1.0 / 9007199254740992.0);
+}
+} // namespace GameplayRandom
+
 #define GA_RPC_MASTER
 #define GA_RPC_PUPPET
 #define GA_RPC_REMOTE
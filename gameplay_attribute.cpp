@@ -1,23 +1,161 @@
 #include "gameplay_attribute.h"
 
+#include <mutex>
+
+namespace {
+/** Guards the schema trie, schemas can be created and freed from any thread. */
+std::mutex schema_mutex;
+/** Current empty schema, it is kept alive by its children and the sets using it. */
+GameplayAttributeSchema *empty_schema = nullptr;
+/** Last serial handed out to a schema, zero marks unresolved handles. */
+std::atomic<uint32_t> schema_serial{ 0 };
+
+/** Returns a new reference to schema or null if it is about to be freed. */
+Ref<GameplayAttributeSchema> acquire_schema(GameplayAttributeSchema *schema) {
+	Ref<GameplayAttributeSchema> result;
+
+	if (schema && schema->reference()) {
+		result = Ref<GameplayAttributeSchema>(schema);
+		schema->unreference();
+	}
+
+	return result;
+}
+} // namespace
+
+GameplayAttributeSchema::GameplayAttributeSchema() :
+		serial(++schema_serial) {
+}
+
+GameplayAttributeSchema::~GameplayAttributeSchema() {
+	std::lock_guard<std::mutex> guard(schema_mutex);
+
+	if (parent.is_valid()) {
+		auto child = parent->children.getptr(names[names.size() - 1]);
+
+		if (child && *child == this) {
+			parent->children.erase(names[names.size() - 1]);
+		}
+	} else if (empty_schema == this) {
+		empty_schema = nullptr;
+	}
+}
+
+Ref<GameplayAttributeSchema> GameplayAttributeSchema::get_empty() {
+	std::lock_guard<std::mutex> guard(schema_mutex);
+	auto result = acquire_schema(empty_schema);
+
+	if (result.is_null()) {
+		result.instance();
+		empty_schema = result.ptr();
+	}
+
+	return result;
+}
+
+Ref<GameplayAttributeSchema> GameplayAttributeSchema::with_attribute(const StringName &name) const {
+	ERR_FAIL_COND_V(indices.has(name), Ref<GameplayAttributeSchema>(const_cast<GameplayAttributeSchema *>(this)));
+
+	std::lock_guard<std::mutex> guard(schema_mutex);
+	auto child = children.getptr(name);
+	auto result = acquire_schema(child ? *child : nullptr);
+
+	if (result.is_null()) {
+		result.instance();
+		result->parent = Ref<GameplayAttributeSchema>(const_cast<GameplayAttributeSchema *>(this));
+		result->names = names;
+		result->names.push_back(name);
+		result->indices = indices;
+		result->indices.set(name, names.size());
+		children.set(name, result.ptr());
+	}
+
+	return result;
+}
+
+Ref<GameplayAttributeSchema> GameplayAttributeSchema::without_attribute(const StringName &name) const {
+	auto result = get_empty();
+
+	for (auto &&attribute_name : names) {
+		if (attribute_name != name) {
+			result = result->with_attribute(attribute_name);
+		}
+	}
+
+	return result;
+}
+
+GameplayAttributeIndex GameplayAttributeSchema::find(const StringName &name) const {
+	auto index = indices.getptr(name);
+	return index ? *index : GAMEPLAY_ATTRIBUTE_INVALID;
+}
+
+const StringName &GameplayAttributeSchema::get_name(GameplayAttributeIndex index) const {
+	return names[index];
+}
+
+int GameplayAttributeSchema::size() const {
+	return names.size();
+}
+
+bool GameplayAttributeSchema::report_missing(const StringName &name) const {
+	std::lock_guard<std::mutex> guard(schema_mutex);
+
+	if (missing.find(name) >= 0) {
+		return false;
+	}
+
+	missing.push_back(name);
+	return true;
+}
+
+uint32_t GameplayAttributeSchema::get_serial() const {
+	return serial;
+}
+
+void GameplayAttributeSchema::_bind_methods() {
+}
+
 void GameplayAttributeData::reset_to_base() {
-	current_value = base_value;
+	set_current_value(get_base_value());
 }
 
 void GameplayAttributeData::set_base_value(double value) {
-	base_value = value;
+	if (owner) {
+		owner->set_base_value(index, value);
+	} else {
+		base_value = value;
+	}
 }
 
 double GameplayAttributeData::get_base_value() const {
-	return base_value;
+	return owner ? owner->get_base_value(index) : base_value;
 }
 
 void GameplayAttributeData::set_current_value(double value) {
-	current_value = value;
+	if (owner) {
+		owner->set_current_value(index, value);
+	} else {
+		current_value = value;
+	}
 }
 
 double GameplayAttributeData::get_current_value() const {
-	return current_value;
+	return owner ? owner->get_current_value(index) : current_value;
+}
+
+void GameplayAttributeData::attach(GameplayAttributeSet *set, GameplayAttributeIndex attribute_index) {
+	owner = set;
+	index = attribute_index;
+}
+
+void GameplayAttributeData::detach() {
+	if (owner) {
+		base_value = owner->get_base_value(index);
+		current_value = owner->get_current_value(index);
+		owner = nullptr;
+		index = GAMEPLAY_ATTRIBUTE_INVALID;
+	}
 }
 
 void GameplayAttributeData::_bind_methods() {
@@ -61,46 +199,265 @@ void GameplayAttribute::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "attribute_data", PROPERTY_HINT_RESOURCE_TYPE, "GameplayAttributeData"), "set_attribute_data", "get_attribute_data");
 }
 
+GameplayAttributeSet::GameplayAttributeSet() :
+		schema(GameplayAttributeSchema::get_empty()) {
+}
+
+GameplayAttributeSet::~GameplayAttributeSet() {
+	// Views may outlive this set, they keep their last values.
+	for (auto &&view : views) {
+		if (view.is_valid()) {
+			view->get_attribute_data()->detach();
+		}
+	}
+}
+
 bool GameplayAttributeSet::has_attribute(const StringName &name) const {
-	return attributes.has(name);
+	return schema->find(name) != GAMEPLAY_ATTRIBUTE_INVALID;
 }
 
 void GameplayAttributeSet::add_attribute(const StringName &name, double base_value) {
 	ERR_FAIL_COND(has_attribute(name));
-	auto attribute = make_reference<GameplayAttribute>();
-	auto attribute_data = make_reference<GameplayAttributeData>();
-	attribute_data->set_base_value(base_value);
-	attribute_data->set_current_value(base_value);
-	attribute->set_attribute_name(name);
-	attribute->set_attribute_data(attribute_data);
-	attributes[name] = attribute;
+	schema = schema->with_attribute(name);
+	base_values.push_back(base_value);
+	current_values.push_back(base_value);
+	dirty.push_back(false);
+	aggregators.push_back(Aggregator());
+	views.push_back(Ref<GameplayAttribute>());
 }
 
 void GameplayAttributeSet::update_attribute(const StringName &name, double base_value, bool reset_current_value /*= true*/) {
-	if (attributes.has(name)) {
-		auto attribute = get_attribute(name);
-		attribute->get_attribute_data()->set_base_value(base_value);
+	auto index = schema->find(name);
+
+	if (index != GAMEPLAY_ATTRIBUTE_INVALID) {
+		auto current_value = get_current_value(index);
+		set_base_value(index, base_value);
 
 		if (reset_current_value) {
-			attribute->get_attribute_data()->reset_to_base();
+			this->reset_current_value(index);
+		} else {
+			set_current_value(index, current_value);
 		}
 	}
 }
 
 void GameplayAttributeSet::remove_attribute(const StringName &name) {
-	attributes.erase(name);
+	auto index = schema->find(name);
+
+	if (index == GAMEPLAY_ATTRIBUTE_INVALID) {
+		return;
+	}
+
+	if (views[index].is_valid()) {
+		views[index]->get_attribute_data()->detach();
+	}
+
+	schema = schema->without_attribute(name);
+	base_values.remove(index);
+	current_values.remove(index);
+	dirty.remove(index);
+	aggregators.remove(index);
+	views.remove(index);
+
+	for (int i = index, n = views.size(); i < n; i++) {
+		if (views[i].is_valid()) {
+			views[i]->get_attribute_data()->attach(this, i);
+		}
+	}
 }
 
 Array GameplayAttributeSet::get_attributes() const {
-	return attributes.values();
+	Array result;
+
+	for (int i = 0, n = schema->size(); i < n; i++) {
+		result.append(get_attribute_by_index(i));
+	}
+
+	return result;
 }
 
 Ref<GameplayAttribute> GameplayAttributeSet::get_attribute(const StringName &name) const {
-	return attributes[name];
+	auto index = schema->find(name);
+	return index != GAMEPLAY_ATTRIBUTE_INVALID ? get_attribute_by_index(index) : Ref<GameplayAttribute>();
 }
 
 Ref<GameplayAttributeData> GameplayAttributeSet::get_attribute_data(const StringName &name) const {
-	return get_attribute(name)->get_attribute_data();
+	auto attribute = get_attribute(name);
+	return attribute.is_valid() ? attribute->get_attribute_data() : Ref<GameplayAttributeData>();
+}
+
+const Ref<GameplayAttributeSchema> &GameplayAttributeSet::get_schema() const {
+	return schema;
+}
+
+GameplayAttributeIndex GameplayAttributeSet::get_attribute_index(const StringName &name) const {
+	return schema->find(name);
+}
+
+int GameplayAttributeSet::get_attribute_count() const {
+	return schema->size();
+}
+
+Ref<GameplayAttribute> GameplayAttributeSet::get_attribute_by_index(GameplayAttributeIndex index) const {
+	ERR_FAIL_INDEX_V(index, views.size(), Ref<GameplayAttribute>());
+
+	if (views[index].is_null()) {
+		auto self = const_cast<GameplayAttributeSet *>(this);
+		auto attribute_data = make_reference<GameplayAttributeData>();
+		attribute_data->attach(self, index);
+
+		auto attribute = make_reference<GameplayAttribute>();
+		attribute->set_attribute_name(schema->get_name(index));
+		attribute->set_attribute_data(attribute_data);
+		views.ptrw()[index] = attribute;
+	}
+
+	return views[index];
+}
+
+double GameplayAttributeSet::get_base_value(GameplayAttributeIndex index) const {
+	ERR_FAIL_INDEX_V(index, base_values.size(), 0.0);
+	return base_values[index];
+}
+
+void GameplayAttributeSet::set_base_value(GameplayAttributeIndex index, double value) {
+	ERR_FAIL_INDEX(index, base_values.size());
+	base_values.ptrw()[index] = value;
+	dirty.ptrw()[index] = true;
+}
+
+double GameplayAttributeSet::get_current_value(GameplayAttributeIndex index) const {
+	ERR_FAIL_INDEX_V(index, current_values.size(), 0.0);
+
+	if (dirty[index]) {
+		auto &&aggregator = aggregators[index];
+		// Overrides pin the value, adjustments apply again once they are removed.
+		current_values.ptrw()[index] = aggregate(index) + (aggregator.overrides.empty() ? aggregator.adjustment : 0.0);
+		dirty.ptrw()[index] = false;
+	}
+
+	return current_values[index];
+}
+
+void GameplayAttributeSet::set_current_value(GameplayAttributeIndex index, double value) {
+	ERR_FAIL_INDEX(index, current_values.size());
+	auto &&aggregator = aggregators.ptrw()[index];
+
+	// Writes can't move a value pinned by an override.
+	if (!aggregator.overrides.empty()) {
+		return;
+	}
+
+	aggregator.adjustment = value - aggregate(index);
+	current_values.ptrw()[index] = value;
+	dirty.ptrw()[index] = false;
+}
+
+void GameplayAttributeSet::reset_current_value(GameplayAttributeIndex index) {
+	ERR_FAIL_INDEX(index, aggregators.size());
+	aggregators.ptrw()[index].adjustment = 0;
+	dirty.ptrw()[index] = true;
+}
+
+void GameplayAttributeSet::add_modifier(GameplayAttributeModifier &modifier) {
+	ERR_FAIL_INDEX(modifier.index, aggregators.size());
+	auto &&aggregator = aggregators.ptrw()[modifier.index];
+	modifier.id = ++modifier_id;
+
+	switch (modifier.type) {
+		case GameplayAttributeModifier::Additive: {
+			aggregator.additive += modifier.magnitude;
+			aggregator.additive_count++;
+		} break;
+		case GameplayAttributeModifier::Multiplicative: {
+			if (modifier.magnitude == 0) {
+				aggregator.zero_multipliers++;
+			} else {
+				aggregator.multiplicative *= modifier.magnitude;
+				aggregator.multiplicative_count++;
+			}
+		} break;
+		case GameplayAttributeModifier::Override: {
+			aggregator.overrides.push_back(modifier);
+		} break;
+	}
+
+	dirty.ptrw()[modifier.index] = true;
+}
+
+void GameplayAttributeSet::remove_modifier(const GameplayAttributeModifier &modifier) {
+	ERR_FAIL_INDEX(modifier.index, aggregators.size());
+	auto &&aggregator = aggregators.ptrw()[modifier.index];
+
+	switch (modifier.type) {
+		case GameplayAttributeModifier::Additive: {
+			// Reset once empty so rounding errors don't accumulate.
+			aggregator.additive = --aggregator.additive_count > 0 ? aggregator.additive - modifier.magnitude : 0;
+		} break;
+		case GameplayAttributeModifier::Multiplicative: {
+			if (modifier.magnitude == 0) {
+				aggregator.zero_multipliers--;
+			} else {
+				aggregator.multiplicative = --aggregator.multiplicative_count > 0 ? aggregator.multiplicative / modifier.magnitude : 1;
+			}
+		} break;
+		case GameplayAttributeModifier::Override: {
+			for (int i = aggregator.overrides.size() - 1; i >= 0; i--) {
+				if (aggregator.overrides[i].id == modifier.id) {
+					aggregator.overrides.remove(i);
+					break;
+				}
+			}
+		} break;
+	}
+
+	dirty.ptrw()[modifier.index] = true;
+}
+
+double GameplayAttributeSet::aggregate(GameplayAttributeIndex index) const {
+	auto &&aggregator = aggregators[index];
+
+	if (!aggregator.overrides.empty()) {
+		return aggregator.overrides[aggregator.overrides.size() - 1].magnitude;
+	}
+	if (aggregator.zero_multipliers > 0) {
+		return 0;
+	}
+
+	return (base_values[index] + aggregator.additive) * aggregator.multiplicative;
+}
+
+GameplayAttributeHandle::GameplayAttributeHandle(const GameplayAttributeHandle &other) :
+		name(other.name) {
+}
+
+GameplayAttributeHandle &GameplayAttributeHandle::operator=(const GameplayAttributeHandle &other) {
+	set_name(other.name);
+	return *this;
+}
+
+void GameplayAttributeHandle::set_name(const StringName &value) {
+	name = value;
+
+	for (auto &&slot : cache) {
+		slot.store(0, std::memory_order_release);
+	}
+}
+
+const StringName &GameplayAttributeHandle::get_name() const {
+	return name;
+}
+
+GameplayAttributeIndex GameplayAttributeHandle::bind(const Ref<GameplayAttributeSchema> &schema) const {
+	auto index = schema->find(name);
+
+	if (index == GAMEPLAY_ATTRIBUTE_INVALID && schema->report_missing(name)) {
+		ERR_PRINTS("Attribute " + String(name) + " is not part of the attribute set.");
+	}
+
+	auto slot = next_slot++ % CACHE_SLOTS;
+	cache[slot].store(static_cast<uint64_t>(schema->get_serial()) << 32 | static_cast<uint32_t>(index), std::memory_order_release);
+	return index;
 }
 
 void GameplayAttributeSet::set_attribute_set_name(const StringName &value) {
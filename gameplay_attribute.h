@@ -10,13 +10,68 @@
 #include <core/variant.h>
 #include <core/vector.h>
 
+#include <atomic>
+
 class GameplayEffect;
 class GameplayAbilitySystem;
+class GameplayAttributeSet;
+
+/** Dense index of an attribute within its attribute set. */
+typedef int GameplayAttributeIndex;
+
+/** Index of attributes which are not part of a set. */
+constexpr GameplayAttributeIndex GAMEPLAY_ATTRIBUTE_INVALID = -1;
+
+/**
+ * Immutable mapping of attribute names to dense indices.
+ * Schemas are shared as a trie, every set which adds the same attributes in the same order uses the same schema.
+ */
+class GAMEPLAY_ABILITIES_API GameplayAttributeSchema : public Reference {
+	GDCLASS(GameplayAttributeSchema, Reference);
+	OBJ_CATEGORY("GameplayAbilities");
+
+public:
+	GameplayAttributeSchema();
+	virtual ~GameplayAttributeSchema();
+
+	/** Returns the shared schema without any attributes. */
+	static Ref<GameplayAttributeSchema> get_empty();
+
+	/** Returns the shared schema with name appended to this one. */
+	Ref<GameplayAttributeSchema> with_attribute(const StringName &name) const;
+	/** Returns the shared schema with name removed from this one, keeping the order of all other attributes. */
+	Ref<GameplayAttributeSchema> without_attribute(const StringName &name) const;
+
+	/** Returns the index of name or GAMEPLAY_ATTRIBUTE_INVALID. */
+	GameplayAttributeIndex find(const StringName &name) const;
+	const StringName &get_name(GameplayAttributeIndex index) const;
+	int size() const;
+	/** Returns an identifier unique to this schema which is never reused. */
+	uint32_t get_serial() const;
+	/** Returns true only the first time name is reported as missing from this schema. */
+	bool report_missing(const StringName &name) const;
 
+private:
+	uint32_t serial = 0;
+	/** Parent schema with one attribute less, null for the empty schema. */
+	Ref<GameplayAttributeSchema> parent;
+	/** Schemas extending this one by a single attribute, entries remove themselves once freed. */
+	mutable HashMap<StringName, GameplayAttributeSchema *> children;
+	Vector<StringName> names;
+	HashMap<StringName, GameplayAttributeIndex> indices;
+	/** Names handles failed to resolve against this schema, each one is reported once. */
+	mutable Vector<StringName> missing;
+
+	static void _bind_methods();
+};
+
+/** Value pair of an attribute, either a view into an attribute set or standalone. */
 class GAMEPLAY_ABILITIES_API GameplayAttributeData : public GameplayResource {
 	GDCLASS(GameplayAttributeData, GameplayResource);
 	OBJ_CATEGORY("GameplayAbilities");
 
+	friend class GameplayAttributeSet;
+
 public:
 	virtual ~GameplayAttributeData() = default;
 
@@ -28,9 +83,15 @@ public:
 	double get_current_value() const;
 
 private:
+	/** Set owning the values or null if this data is standalone. */
+	GameplayAttributeSet *owner = nullptr;
+	GameplayAttributeIndex index = GAMEPLAY_ATTRIBUTE_INVALID;
 	double base_value = 0;
 	double current_value = 0;
 
+	void attach(GameplayAttributeSet *set, GameplayAttributeIndex attribute_index);
+	void detach();
+
 	static void _bind_methods();
 };
 
@@ -53,12 +114,37 @@ private:
 	static void _bind_methods();
 };
 
+/** Removable contribution of an active effect to a single attribute. */
+struct GameplayAttributeModifier {
+	enum Type {
+		/** Added to the base value. */
+		Additive,
+		/** Multiplied with base value and additive contributions. */
+		Multiplicative,
+		/** Replaces the current value, the latest override wins. */
+		Override
+	};
+
+	GameplayAttributeIndex index = GAMEPLAY_ATTRIBUTE_INVALID;
+	Type type = Additive;
+	double magnitude = 0;
+	/** Assigned by the attribute set, increases with every added modifier. */
+	uint64_t id = 0;
+};
+
+/**
+ * Attribute values stored as contiguous base and current value arrays indexed through a shared schema.
+ * Attributes and attribute data handed out to scripts are views into these arrays.
+ * Current values are derived from the base value and active modifiers, they are recomputed lazily when read after a change.
+ * Writes to the current value are kept as an adjustment on top of the modifiers so they survive recomputation.
+ */
 class GAMEPLAY_ABILITIES_API GameplayAttributeSet : public GameplayResource {
 	GDCLASS(GameplayAttributeSet, GameplayResource);
 	OBJ_CATEGORY("GameplayAbilities");
 
 public:
-	virtual ~GameplayAttributeSet() = default;
+	GameplayAttributeSet();
+	virtual ~GameplayAttributeSet();
 
 	bool has_attribute(const StringName &name) const;
 	void add_attribute(const StringName &name, double base_value);
@@ -69,12 +155,99 @@ public:
 	Ref<GameplayAttribute> get_attribute(const StringName &name) const;
 	Ref<GameplayAttributeData> get_attribute_data(const StringName &name) const;
 
+	/** Index based access intended for native hot paths, indices stay valid until an attribute gets removed. */
+	const Ref<GameplayAttributeSchema> &get_schema() const;
+	GameplayAttributeIndex get_attribute_index(const StringName &name) const;
+	int get_attribute_count() const;
+	Ref<GameplayAttribute> get_attribute_by_index(GameplayAttributeIndex index) const;
+	double get_base_value(GameplayAttributeIndex index) const;
+	void set_base_value(GameplayAttributeIndex index, double value);
+	double get_current_value(GameplayAttributeIndex index) const;
+	/** Sets the current value by adjusting it relative to the base value and active modifiers, ignored while an override is active. */
+	void set_current_value(GameplayAttributeIndex index, double value);
+	/** Drops adjustments made through set_current_value, the current value follows base value and modifiers again. */
+	void reset_current_value(GameplayAttributeIndex index);
+
+	/** Adds a modifier to its attribute and assigns its id. */
+	void add_modifier(GameplayAttributeModifier &modifier);
+	/** Removes a modifier previously added to this set. */
+	void remove_modifier(const GameplayAttributeModifier &modifier);
+
 	void set_attribute_set_name(const StringName &value);
 	StringName get_attribute_set_name() const;
 
 private:
 	StringName attribute_set_name;
-	Dictionary attributes;
+	Ref<GameplayAttributeSchema> schema;
+	/** Bucketed modifiers of a single attribute. */
+	struct Aggregator {
+		/** Sum of additive modifiers. */
+		double additive = 0;
+		/** Product of all non-zero multiplicative modifiers. */
+		double multiplicative = 1;
+		int additive_count = 0;
+		int multiplicative_count = 0;
+		/** Amount of multiplicative modifiers which are zero. */
+		int zero_multipliers = 0;
+		/** Active overrides in order of application. */
+		Vector<GameplayAttributeModifier> overrides;
+		/** Offset of explicitly written current values, applied after all modifiers unless an override is active. */
+		double adjustment = 0;
+	};
+
+	Vector<double> base_values;
+	mutable Vector<double> current_values;
+	/** Set for attributes whose current value has to be recomputed. */
+	mutable Vector<uint8_t> dirty;
+	Vector<Aggregator> aggregators;
+	uint64_t modifier_id = 0;
+	/** Lazily created views parallel to the values. */
+	mutable Vector<Ref<GameplayAttribute> > views;
+
+	/** Value of the attribute given its base value and active modifiers, without adjustment. */
+	double aggregate(GameplayAttributeIndex index) const;
 
 	static void _bind_methods();
 };
+
+/**
+ * Attribute name which is resolved once per schema instead of being looked up on every use.
+ * Schema serial and index are cached in a single atomic per slot so shared resources can be resolved from any thread.
+ * Several slots keep resources shared by sets of different schemas, e.g. players and NPCs, from resolving again on every alternation.
+ */
+class GAMEPLAY_ABILITIES_API GameplayAttributeHandle {
+public:
+	GameplayAttributeHandle() = default;
+	GameplayAttributeHandle(const GameplayAttributeHandle &other);
+	GameplayAttributeHandle &operator=(const GameplayAttributeHandle &other);
+
+	void set_name(const StringName &value);
+	const StringName &get_name() const;
+
+	/** Returns the index within set or GAMEPLAY_ATTRIBUTE_INVALID, unknown attributes are reported once per schema. */
+	GameplayAttributeIndex resolve(const GameplayAttributeSet *set) const {
+		auto &&schema = set->get_schema();
+		auto serial = schema->get_serial();
+
+		for (auto &&slot : cache) {
+			auto cached = slot.load(std::memory_order_acquire);
+
+			if (static_cast<uint32_t>(cached >> 32) == serial) {
+				return static_cast<GameplayAttributeIndex>(static_cast<uint32_t>(cached));
+			}
+		}
+
+		return bind(schema);
+	}
+
+private:
+	static constexpr int CACHE_SLOTS = 4;
+
+	StringName name;
+	/** Schema serial in the upper and index in the lower 32 bits per slot, zero if unresolved. */
+	mutable std::atomic<uint64_t> cache[CACHE_SLOTS] = {};
+	/** Slot the next schema gets bound to, slots are replaced round robin. */
+	mutable std::atomic<uint32_t> next_slot{ 0 };
+
+	GameplayAttributeIndex bind(const Ref<GameplayAttributeSchema> &schema) const;
+};
@@ -0,0 +1,70 @@
+#include "gameplay_calculator.h"
+
+GameplayCalculatorRegistry *GameplayCalculatorRegistry::singleton = nullptr;
+
+GameplayCalculatorRegistry::GameplayCalculatorRegistry() :
+		lock(RWLock::create()) {
+	singleton = this;
+}
+
+GameplayCalculatorRegistry::~GameplayCalculatorRegistry() {
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
+
+GameplayCalculatorRegistry *GameplayCalculatorRegistry::get_singleton() {
+	return singleton;
+}
+
+void GameplayCalculatorRegistry::register_magnitude_calculator(const StringName &name, GameplayMagnitudeCalculator calculator) {
+	ERR_FAIL_COND(name == StringName());
+	RWLockWrite write_lock(lock.get());
+	calculators[name].magnitude = calculator;
+}
+
+void GameplayCalculatorRegistry::register_requirement_calculator(const StringName &name, GameplayRequirementCalculator calculator) {
+	ERR_FAIL_COND(name == StringName());
+	RWLockWrite write_lock(lock.get());
+	calculators[name].requirement = calculator;
+}
+
+void GameplayCalculatorRegistry::register_execution_calculator(const StringName &name, GameplayExecutionCalculator calculator) {
+	ERR_FAIL_COND(name == StringName());
+	RWLockWrite write_lock(lock.get());
+	calculators[name].execution = calculator;
+}
+
+void GameplayCalculatorRegistry::unregister_calculator(const StringName &name) {
+	RWLockWrite write_lock(lock.get());
+	calculators.erase(name);
+}
+
+GameplayMagnitudeCalculator GameplayCalculatorRegistry::get_magnitude_calculator(const StringName &name) const {
+	RWLockRead read_lock(lock.get());
+	auto entry = calculators.getptr(name);
+	return entry ? entry->magnitude : nullptr;
+}
+
+GameplayRequirementCalculator GameplayCalculatorRegistry::get_requirement_calculator(const StringName &name) const {
+	RWLockRead read_lock(lock.get());
+	auto entry = calculators.getptr(name);
+	return entry ? entry->requirement : nullptr;
+}
+
+GameplayExecutionCalculator GameplayCalculatorRegistry::get_execution_calculator(const StringName &name) const {
+	RWLockRead read_lock(lock.get());
+	auto entry = calculators.getptr(name);
+	return entry ? entry->execution : nullptr;
+}
+
+bool GameplayCalculatorRegistry::has_calculator(const StringName &name) const {
+	RWLockRead read_lock(lock.get());
+	return calculators.has(name);
+}
+
+void GameplayCalculatorRegistry::_bind_methods() {
+	/** Methods */
+	ClassDB::bind_method(D_METHOD("unregister_calculator", "name"), &GameplayCalculatorRegistry::unregister_calculator);
+	ClassDB::bind_method(D_METHOD("has_calculator", "name"), &GameplayCalculatorRegistry::has_calculator);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "gameplay_node.h"
+
+#include <core/hash_map.h>
+#include <core/object.h>
+#include <core/os/rw_lock.h>
+
+class GameplayEffect;
+class GameplayEffectCustomExecutionResult;
+class GameplayEffectNode;
+
+/** Native replacement for a CustomMagnitudeCalculator script. */
+typedef double (*GameplayMagnitudeCalculator)(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level);
+/** Native replacement for a GameplayEffectCustomApplicationRequirementScript. */
+typedef bool (*GameplayRequirementCalculator)(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level);
+/** Native replacement for a GameplayEffectCustomExecutionScript. */
+typedef Ref<GameplayEffectCustomExecutionResult> (*GameplayExecutionCalculator)(Node *source, Node *target, GameplayEffectNode *effect, int64_t level, double normalised_level);
+
+/**
+ * Process wide registry of native calculators which modules register by name.
+ * Resources referencing a calculator by name call it directly instead of going through a script instance.
+ */
+class GAMEPLAY_ABILITIES_API GameplayCalculatorRegistry : public Object {
+	GDCLASS(GameplayCalculatorRegistry, Object);
+	OBJ_CATEGORY("GameplayAbilities");
+
+public:
+	GameplayCalculatorRegistry();
+	virtual ~GameplayCalculatorRegistry();
+
+	static GameplayCalculatorRegistry *get_singleton();
+
+	/** Registers or replaces a magnitude calculator. */
+	void register_magnitude_calculator(const StringName &name, GameplayMagnitudeCalculator calculator);
+	/** Registers or replaces an application requirement calculator. */
+	void register_requirement_calculator(const StringName &name, GameplayRequirementCalculator calculator);
+	/** Registers or replaces a custom execution calculator. */
+	void register_execution_calculator(const StringName &name, GameplayExecutionCalculator calculator);
+	/** Removes all calculators registered under name. */
+	void unregister_calculator(const StringName &name);
+
+	/** Returns the magnitude calculator or null if none is registered. */
+	GameplayMagnitudeCalculator get_magnitude_calculator(const StringName &name) const;
+	/** Returns the requirement calculator or null if none is registered. */
+	GameplayRequirementCalculator get_requirement_calculator(const StringName &name) const;
+	/** Returns the execution calculator or null if none is registered. */
+	GameplayExecutionCalculator get_execution_calculator(const StringName &name) const;
+	/** Returns true if any calculator is registered under name. */
+	bool has_calculator(const StringName &name) const;
+
+private:
+	struct CalculatorEntry {
+		GameplayMagnitudeCalculator magnitude = nullptr;
+		GameplayRequirementCalculator requirement = nullptr;
+		GameplayExecutionCalculator execution = nullptr;
+	};
+
+	static GameplayCalculatorRegistry *singleton;
+
+	/** Calculators by their registered name. */
+	HashMap<StringName, CalculatorEntry> calculators;
+	/** Guards registry access as modules can register at any time. */
+	GameplayPtr<RWLock> lock;
+
+	static void _bind_methods();
+};
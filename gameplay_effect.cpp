@@ -2,21 +2,28 @@
 #include "gameplay_ability.h"
 #include "gameplay_ability_system.h"
 #include "gameplay_attribute.h"
+#include "gameplay_calculator.h"
 #include "gameplay_effect_magnitude.h"
 #include "gameplay_tags.h"
 
 #include <scene/resources/packed_scene.h>
 
 void GameplayEffectModifier::set_attribute(const StringName &value) {
-	attribute = value;
+	attribute.set_name(value);
+	emit_changed();
 }
 
 StringName GameplayEffectModifier::get_attribute() const {
+	return attribute.get_name();
+}
+
+const GameplayAttributeHandle &GameplayEffectModifier::get_attribute_handle() const {
 	return attribute;
 }
 
 void GameplayEffectModifier::set_modifier_operation(ModifierOperation::Type value) {
 	modifier_operation = value;
+	emit_changed();
 }
 
 ModifierOperation::Type GameplayEffectModifier::get_modifier_operation() const {
@@ -25,6 +32,7 @@ ModifierOperation::Type GameplayEffectModifier::get_modifier_operation() const {
 
 void GameplayEffectModifier::set_modifier_magnitude(const Ref<GameplayEffectMagnitude> &value) {
 	modifier_magnitude = value;
+	emit_changed();
 }
 
 Ref<GameplayEffectMagnitude> GameplayEffectModifier::get_modifier_magnitude() const {
@@ -74,8 +82,23 @@ void GameplayEffectCustomExecutionScript::_bind_methods() {
 }
 
 Ref<GameplayEffectCustomExecutionResult> GameplayEffectCustomExecution::execute(Node *source, Node *target, GameplayEffectNode *effect, int64_t level, double normalised_level) {
-	if (script.is_null()) {
-		script = GameplayPtr<ScriptInstance>(execution_script->instance_create(this));
+	if (native_calculator != StringName()) {
+		auto calculator = GameplayCalculatorRegistry::get_singleton()->get_execution_calculator(native_calculator);
+		if (!calculator) {
+			ERR_EXPLAIN("Native execution calculator is not registered: " + String(native_calculator));
+			ERR_FAIL_V({});
+		}
+
+		return calculator(source, target, effect, level, normalised_level);
+	}
+
+	if (!script_created.load(std::memory_order_acquire)) {
+		MutexLock cache_lock(get_cache_mutex());
+
+		if (!script_created.load(std::memory_order_relaxed)) {
+			script = GameplayPtr<ScriptInstance>(execution_script->instance_create(this));
+			script_created.store(true, std::memory_order_release);
+		}
 	}
 	if (script.is_valid()) {
 		return script->call("_execute", source, target, effect, level, normalised_level);
@@ -94,13 +117,24 @@ Ref<Script> GameplayEffectCustomExecution::get_execution_script() {
 	return execution_script;
 }
 
+void GameplayEffectCustomExecution::set_native_calculator(const StringName &value) {
+	native_calculator = value;
+}
+
+StringName GameplayEffectCustomExecution::get_native_calculator() const {
+	return native_calculator;
+}
+
 void GameplayEffectCustomExecution::_bind_methods() {
 	/** Methods */
 	ClassDB::bind_method(D_METHOD("set_execution_script"), &GameplayEffectCustomExecution::set_execution_script);
 	ClassDB::bind_method(D_METHOD("get_execution_script"), &GameplayEffectCustomExecution::get_execution_script);
+	ClassDB::bind_method(D_METHOD("set_native_calculator", "value"), &GameplayEffectCustomExecution::set_native_calculator);
+	ClassDB::bind_method(D_METHOD("get_native_calculator"), &GameplayEffectCustomExecution::get_native_calculator);
 
 	/** Properties */
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "execution_script", PROPERTY_HINT_RESOURCE_TYPE, "Script"), "set_execution_script", "get_execution_script");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "native_calculator"), "set_native_calculator", "get_native_calculator");
 }
 
 void GameplayEffectCustomExecutionResult::_bind_methods() {
@@ -116,8 +150,23 @@ void GameplayEffectCustomApplicationRequirementScript::_bind_methods() {
 }
 
 bool GameplayEffectCustomApplicationRequirement::execute(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) {
-	if (script.is_null()) {
-		script = GameplayPtr<ScriptInstance>(requirement_script->instance_create(this));
+	if (native_calculator != StringName()) {
+		auto calculator = GameplayCalculatorRegistry::get_singleton()->get_requirement_calculator(native_calculator);
+		if (!calculator) {
+			ERR_EXPLAIN("Native requirement calculator is not registered: " + String(native_calculator));
+			ERR_FAIL_V(true);
+		}
+
+		return calculator(source, target, effect, level, normalised_level);
+	}
+
+	if (!script_created.load(std::memory_order_acquire)) {
+		MutexLock cache_lock(get_cache_mutex());
+
+		if (!script_created.load(std::memory_order_relaxed)) {
+			script = GameplayPtr<ScriptInstance>(requirement_script->instance_create(this));
+			script_created.store(true, std::memory_order_release);
+		}
 	}
 	if (script.is_valid()) {
 		return script->call("_execute", source, target, effect, level, normalised_level);
@@ -136,13 +185,24 @@ Ref<Script> GameplayEffectCustomApplicationRequirement::get_requirement_script()
 	return requirement_script;
 }
 
+void GameplayEffectCustomApplicationRequirement::set_native_calculator(const StringName &value) {
+	native_calculator = value;
+}
+
+StringName GameplayEffectCustomApplicationRequirement::get_native_calculator() const {
+	return native_calculator;
+}
+
 void GameplayEffectCustomApplicationRequirement::_bind_methods() {
 	/** Methods */
 	ClassDB::bind_method(D_METHOD("set_requirement_script"), &GameplayEffectCustomApplicationRequirement::set_requirement_script);
 	ClassDB::bind_method(D_METHOD("get_requirement_script"), &GameplayEffectCustomApplicationRequirement::get_requirement_script);
+	ClassDB::bind_method(D_METHOD("set_native_calculator", "value"), &GameplayEffectCustomApplicationRequirement::set_native_calculator);
+	ClassDB::bind_method(D_METHOD("get_native_calculator"), &GameplayEffectCustomApplicationRequirement::get_native_calculator);
 
 	/** Properties */
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "requirement_script", PROPERTY_HINT_RESOURCE_TYPE, "Script"), "set_requirement_script", "get_requirement_script");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "native_calculator"), "set_native_calculator", "get_native_calculator");
 }
 
 bool ConditionalGameplayEffect::can_apply(const Ref<GameplayTagContainer> &source_tags) const {
@@ -221,8 +281,20 @@ void GameplayEffectCue::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "cue_tags", PROPERTY_HINT_RESOURCE_TYPE, "GameplayTagContainer"), "set_cue_tags", "get_cue_tags");
 }
 
+GameplayEffectSpec::Modifier GameplayEffectSpec::compile_modifier(const Ref<GameplayEffectModifier> &modifier) {
+	Modifier result;
+	result.attribute = modifier->get_attribute_handle();
+	result.operation = modifier->get_modifier_operation();
+	result.magnitude = modifier->get_modifier_magnitude();
+	return result;
+}
+
+void GameplayEffectSpec::_bind_methods() {
+}
+
 void GameplayEffect::set_effect_name(const StringName &value) {
 	effect_name = value;
+	invalidate_spec();
 }
 
 StringName GameplayEffect::get_effect_name() const {
@@ -231,6 +303,7 @@ StringName GameplayEffect::get_effect_name() const {
 
 void GameplayEffect::set_duration_type(DurationType::Type value) {
 	duration_type = value;
+	invalidate_spec();
 }
 
 DurationType::Type GameplayEffect::get_duration_type() const {
@@ -247,6 +320,7 @@ Ref<GameplayEffectMagnitude> GameplayEffect::get_duration_magnitude() const {
 
 void GameplayEffect::set_period(const Ref<ScalableFloat> &value) {
 	period = value;
+	invalidate_spec();
 }
 
 Ref<ScalableFloat> GameplayEffect::get_period() const {
@@ -263,6 +337,7 @@ bool GameplayEffect::get_execute_period_on_application() const {
 
 void GameplayEffect::set_modifiers(const Array &value) {
 	modifiers = value;
+	invalidate_spec();
 }
 
 const Array &GameplayEffect::get_modifiers() const {
@@ -271,6 +346,7 @@ const Array &GameplayEffect::get_modifiers() const {
 
 void GameplayEffect::set_executions(const Array &value) {
 	executions = value;
+	invalidate_spec();
 }
 
 const Array &GameplayEffect::get_executions() const {
@@ -279,6 +355,7 @@ const Array &GameplayEffect::get_executions() const {
 
 void GameplayEffect::set_infliction_chance(const Ref<ScalableFloat> &value) {
 	infliction_chance = value;
+	invalidate_spec();
 }
 
 Ref<ScalableFloat> GameplayEffect::get_infliction_chance() const {
@@ -287,6 +364,7 @@ Ref<ScalableFloat> GameplayEffect::get_infliction_chance() const {
 
 void GameplayEffect::set_application_requirements(const Array &value) {
 	application_requirements = value;
+	invalidate_spec();
 }
 
 const Array &GameplayEffect::get_application_requirements() const {
@@ -295,6 +373,7 @@ const Array &GameplayEffect::get_application_requirements() const {
 
 void GameplayEffect::set_conditional_erffects(const Array &value) {
 	conditional_erffects = value;
+	invalidate_spec();
 }
 
 const Array &GameplayEffect::get_conditional_erffects() const {
@@ -311,6 +390,7 @@ const Array &GameplayEffect::get_overflow_effects() const {
 
 void GameplayEffect::set_deny_overflow_application(bool value) {
 	deny_overflow_application = value;
+	invalidate_spec();
 }
 
 bool GameplayEffect::get_deny_overflow_application() const {
@@ -421,6 +501,7 @@ Ref<GameplayTagContainer> GameplayEffect::get_cancel_ability_tags() const {
 
 void GameplayEffect::set_stacking_type(StackingType::Type value) {
 	stacking_type = value;
+	invalidate_spec();
 }
 
 StackingType::Type GameplayEffect::get_stacking_type() const {
@@ -429,6 +510,7 @@ StackingType::Type GameplayEffect::get_stacking_type() const {
 
 void GameplayEffect::set_maximum_stacks(int64_t value) {
 	maximum_stacks = value;
+	invalidate_spec();
 }
 
 int64_t GameplayEffect::get_maximum_stacks() const {
@@ -467,6 +549,74 @@ const Array &GameplayEffect::get_granted_abilities() const {
 	return granted_abilities;
 }
 
+Ref<GameplayEffectSpec> GameplayEffect::get_spec() const {
+	if (spec_compiled.load(std::memory_order_acquire)) {
+		return spec;
+	}
+
+	MutexLock cache_lock(get_cache_mutex());
+
+	if (spec_compiled.load(std::memory_order_relaxed)) {
+		return spec;
+	}
+
+	auto self = const_cast<GameplayEffect *>(this);
+	Ref<GameplayEffectSpec> result;
+	result.instance();
+	result->effect_name = effect_name;
+	result->duration_type = duration_type;
+	result->stacking_type = stacking_type;
+	result->maximum_stacks = maximum_stacks;
+	result->deny_overflow_application = deny_overflow_application;
+	result->infliction_chance = infliction_chance;
+	result->aggregated = duration_type != DurationType::Instant && period.is_null();
+	result->linear = executions.empty();
+
+	for (Ref<GameplayEffectModifier> modifier : modifiers) {
+		if (modifier.is_null()) {
+			continue;
+		}
+		if (!modifier->is_connected("changed", self, "_on_modifier_changed")) {
+			modifier->connect("changed", self, "_on_modifier_changed");
+		}
+
+		auto &&compiled = GameplayEffectSpec::compile_modifier(modifier);
+		auto constant = dynamic_cast<ScalableFloat *>(compiled.magnitude.ptr()) != nullptr;
+		auto additive = compiled.operation == ModifierOperation::Add || compiled.operation == ModifierOperation::Subtract;
+		result->linear = result->linear && constant && additive;
+		result->modifiers.push_back(compiled);
+	}
+	for (Ref<GameplayEffectCustomExecution> execution : executions) {
+		result->executions.push_back(execution);
+	}
+	for (Ref<GameplayEffectCustomApplicationRequirement> requirement : application_requirements) {
+		result->application_requirements.push_back(requirement);
+	}
+	for (Ref<ConditionalGameplayEffect> conditional : conditional_erffects) {
+		result->conditional_effects.push_back(conditional);
+	}
+
+	result->effect_tags = effect_tags;
+	result->ongoing_tags = ongoing_tags;
+	result->remove_effect_tags = remove_effect_tags;
+	result->application_immunity_tags = application_immunity_tags;
+	result->cancel_ability_tags = cancel_ability_tags;
+
+	spec = result;
+	spec_compiled.store(true, std::memory_order_release);
+	return spec;
+}
+
+void GameplayEffect::invalidate_spec() {
+	spec_compiled.store(false, std::memory_order_release);
+	spec.unref();
+	emit_changed();
+}
+
+void GameplayEffect::_on_modifier_changed() {
+	invalidate_spec();
+}
+
 void GameplayEffect::_bind_methods() {
 	/** Methods */
 	ClassDB::bind_method(D_METHOD("set_effect_name", "value"), &GameplayEffect::set_effect_name);
@@ -533,6 +683,8 @@ void GameplayEffect::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_granted_abilities", "value"), &GameplayEffect::set_granted_abilities);
 	ClassDB::bind_method(D_METHOD("get_granted_abilities"), &GameplayEffect::get_granted_abilities);
 
+	ClassDB::bind_method(D_METHOD("_on_modifier_changed"), &GameplayEffect::_on_modifier_changed);
+
 	/** Properties */
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "effect_name"), "set_effect_name", "get_effect_name");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "duration_type", PROPERTY_HINT_ENUM, "Instant,Infinte,Has Duration"), "set_duration_type", "get_duration_type");
@@ -1,8 +1,12 @@
 #pragma once
 
 //#include "gameplay_effect_magnitude.h"
+#include "gameplay_attribute.h"
+#include "gameplay_calculator.h"
 #include "gameplay_node.h"
 
+#include <atomic>
+
 class GameplayTagContainer;
 class GameplayAttribute;
 class GameplayEffect;
@@ -107,6 +111,7 @@ public:
 
 	void set_attribute(const StringName &value);
 	StringName get_attribute() const;
+	const GameplayAttributeHandle &get_attribute_handle() const;
 	void set_modifier_operation(ModifierOperation::Type value);
 	ModifierOperation::Type get_modifier_operation() const;
 	void set_modifier_magnitude(const Ref<GameplayEffectMagnitude> &value);
@@ -120,7 +125,7 @@ private:
 	static constexpr auto MODIFIER_OPERATION_OVERRIDE = ModifierOperation::Override;
 
 	/** Attribute that gets modified. */
-	StringName attribute;
+	GameplayAttributeHandle attribute;
 	/** Operation for modification. */
 	ModifierOperation::Type modifier_operation = ModifierOperation::Add;
 	/** Magnitude to apply. */
@@ -185,13 +190,19 @@ public:
 
 	void set_execution_script(const Ref<Script> &value);
 	Ref<Script> get_execution_script();
+	void set_native_calculator(const StringName &value);
+	StringName get_native_calculator() const;
 
 private:
 	/** Calculation script which inherits from GameplayEffectCustomExecutionScript or implements at least the required method. */
 	Ref<Script> execution_script;
+	/** Name of a calculator in GameplayCalculatorRegistry, takes precedence over the script. */
+	StringName native_calculator;
 
 	/** Laze loaded script instance. Will be created at first usage and used henceforth. */
 	GameplayPtr<ScriptInstance> script = nullptr;
+	/** Set once script is created, read without locking by calls on world workers. */
+	std::atomic<bool> script_created{ false };
 
 	static void _bind_methods();
 };
@@ -220,13 +231,19 @@ public:
 
 	void set_requirement_script(const Ref<Script> &value);
 	Ref<Script> get_requirement_script();
+	void set_native_calculator(const StringName &value);
+	StringName get_native_calculator() const;
 
 private:
 	/** Requirement script which returns true if effect can be applied. */
 	Ref<Script> requirement_script;
+	/** Name of a calculator in GameplayCalculatorRegistry, takes precedence over the script. */
+	StringName native_calculator;
 
 	/** Laze loaded script instance. Will be created at first usage and used henceforth. */
 	GameplayPtr<ScriptInstance> script = nullptr;
+	/** Set once script is created, read without locking by calls on world workers. */
+	std::atomic<bool> script_created{ false };
 
 	static void _bind_methods();
 };
@@ -282,6 +299,78 @@ private:
 	static void _bind_methods();
 };
 
+/**
+ * Immutable, flattened form of a GameplayEffect which ability systems apply and execute.
+ * Compiled on first use and replaced once the effect or one of its modifiers changes.
+ */
+class GAMEPLAY_ABILITIES_API GameplayEffectSpec : public Reference {
+	GDCLASS(GameplayEffectSpec, Reference);
+	OBJ_CATEGORY("GameplayAbilities");
+
+	friend class GameplayEffect;
+
+public:
+	/** Modifier with its attribute resolved once per attribute schema. */
+	struct Modifier {
+		GameplayAttributeHandle attribute;
+		ModifierOperation::Type operation = ModifierOperation::Add;
+		Ref<GameplayEffectMagnitude> magnitude;
+	};
+
+	virtual ~GameplayEffectSpec() = default;
+
+	/** Compiles a single modifier, e.g. one returned by a custom execution. */
+	static Modifier compile_modifier(const Ref<GameplayEffectModifier> &modifier);
+
+	const StringName &get_effect_name() const { return effect_name; }
+	DurationType::Type get_duration_type() const { return duration_type; }
+	StackingType::Type get_stacking_type() const { return stacking_type; }
+	int64_t get_maximum_stacks() const { return maximum_stacks; }
+	bool get_deny_overflow_application() const { return deny_overflow_application; }
+	const Ref<ScalableFloat> &get_infliction_chance() const { return infliction_chance; }
+
+	const Vector<Modifier> &get_modifiers() const { return modifiers; }
+	const Vector<Ref<GameplayEffectCustomExecution> > &get_executions() const { return executions; }
+	const Vector<Ref<GameplayEffectCustomApplicationRequirement> > &get_application_requirements() const { return application_requirements; }
+	const Vector<Ref<ConditionalGameplayEffect> > &get_conditional_effects() const { return conditional_effects; }
+
+	const Ref<GameplayTagContainer> &get_effect_tags() const { return effect_tags; }
+	const Ref<GameplayTagContainer> &get_ongoing_tags() const { return ongoing_tags; }
+	const Ref<GameplayTagContainer> &get_remove_effect_tags() const { return remove_effect_tags; }
+	const Ref<GameplayTagContainer> &get_application_immunity_tags() const { return application_immunity_tags; }
+	const Ref<GameplayTagContainer> &get_cancel_ability_tags() const { return cancel_ability_tags; }
+
+	/** Returns true if modifiers last as long as the effect instead of changing base values. */
+	bool is_aggregated() const { return aggregated; }
+	/** Returns true if several period ticks can be applied at once, i.e. it only adds or subtracts constant magnitudes. */
+	bool is_linear() const { return linear; }
+
+private:
+	StringName effect_name;
+	DurationType::Type duration_type = DurationType::Instant;
+	StackingType::Type stacking_type = StackingType::None;
+	int64_t maximum_stacks = 1;
+	bool deny_overflow_application = false;
+	Ref<ScalableFloat> infliction_chance;
+
+	Vector<Modifier> modifiers;
+	Vector<Ref<GameplayEffectCustomExecution> > executions;
+	Vector<Ref<GameplayEffectCustomApplicationRequirement> > application_requirements;
+	Vector<Ref<ConditionalGameplayEffect> > conditional_effects;
+
+	/** Tag containers are shared with the effect, they keep their interned ids up to date themselves. */
+	Ref<GameplayTagContainer> effect_tags;
+	Ref<GameplayTagContainer> ongoing_tags;
+	Ref<GameplayTagContainer> remove_effect_tags;
+	Ref<GameplayTagContainer> application_immunity_tags;
+	Ref<GameplayTagContainer> cancel_ability_tags;
+
+	bool aggregated = false;
+	bool linear = false;
+
+	static void _bind_methods();
+};
+
 /**
  * Effect class is a data holder which gets applied to the target and defines how and what gets modified in what capacity.
  */
@@ -356,6 +445,9 @@ public:
 	void set_granted_abilities(const Array &value);
 	const Array &get_granted_abilities() const;
 
+	/** Returns the compiled form of this effect, built on first use. */
+	Ref<GameplayEffectSpec> get_spec() const;
+
 private:
 	static constexpr auto DURATION_TYPE_INSTANT = DurationType::Instant;
 	static constexpr auto DURATION_TYPE_INFINITE = DurationType::Infinite;
@@ -439,5 +531,13 @@ private:
 	/** Abilities added to target while this effect is active. */
 	ArrayContainer<PackedScene> granted_abilities;
 
+	/** Compiled form of this effect, reset whenever the effect or one of its modifiers changes. */
+	mutable Ref<GameplayEffectSpec> spec;
+	/** Set once spec is compiled, read without locking by world workers applying this effect. */
+	mutable std::atomic<bool> spec_compiled{ false };
+
+	void invalidate_spec();
+	void _on_modifier_changed();
+
 	static void _bind_methods();
 };
@@ -5,24 +5,124 @@
 #include "gameplay_effect.h"
 #include "gameplay_tags.h"
 
+#include <algorithm>
 #include <array>
 #include <iostream>
+#include <iterator>
 
 double GameplayEffectMagnitude::calculate_magnitude(const Node *, const Node *, const Ref<GameplayEffect> &, int64_t, double) {
 	return 0;
 }
 
+const GameplayMagnitudeProgram &GameplayEffectMagnitude::get_program() {
+	if (!compiled.load(std::memory_order_acquire)) {
+		MutexLock cache_lock(get_cache_mutex());
+
+		if (!compiled.load(std::memory_order_relaxed)) {
+			program = GameplayMagnitudeProgram();
+			compile_program();
+			compiled.store(true, std::memory_order_release);
+		}
+	}
+
+	return program;
+}
+
+void GameplayEffectMagnitude::compile_program() {
+}
+
+void GameplayEffectMagnitude::compile_terms(const Ref<ScalableFloat> &coefficient, const Ref<ScalableFloat> &pre_multiply_addition, const Ref<ScalableFloat> &post_multiply_addition) {
+	auto compile_term = [this](GameplayMagnitudeProgram::Term &term, const Ref<ScalableFloat> &value) {
+		if (value.is_null()) {
+			return;
+		}
+		if (!value->is_connected("changed", this, "_on_term_changed")) {
+			value->connect("changed", this, "_on_term_changed");
+		}
+
+		if (value->get_curve().is_null() || value->get_value() == 0) {
+			term.value = value->get_value();
+		} else {
+			term.scaled = value.ptr();
+			program.constant = false;
+		}
+	};
+
+	compile_term(program.coefficient, coefficient);
+	compile_term(program.pre_multiply_addition, pre_multiply_addition);
+	compile_term(program.post_multiply_addition, post_multiply_addition);
+}
+
+void GameplayEffectMagnitude::release_term(const Ref<ScalableFloat> &term) {
+	if (term.is_valid() && term->is_connected("changed", this, "_on_term_changed")) {
+		term->disconnect("changed", this, "_on_term_changed");
+	}
+
+	invalidate_program();
+}
+
+void GameplayEffectMagnitude::invalidate_program() {
+	compiled.store(false, std::memory_order_release);
+}
+
+void GameplayEffectMagnitude::_on_term_changed() {
+	invalidate_program();
+}
+
 void GameplayEffectMagnitude::_bind_methods() {
 	/** Methods */
 	ClassDB::bind_method(D_METHOD("calculate_magnitude", "source", "target", "effect", "level"), &GameplayEffectMagnitude::calculate_magnitude);
+	ClassDB::bind_method(D_METHOD("_on_term_changed"), &GameplayEffectMagnitude::_on_term_changed);
 }
 
 double ScalableFloat::calculate_magnitude(const Node *, const Node *, const Ref<GameplayEffect> &, int64_t, double level) {
-	return curve.is_valid() ? value * curve->interpolate(level) : value;
+	return evaluate(level);
+}
+
+double ScalableFloat::evaluate(double level) {
+	if (curve.is_null()) {
+		return value;
+	} else if (bake_resolution <= 0) {
+		return value * curve->interpolate(level);
+	}
+
+	if (!baked.load(std::memory_order_acquire)) {
+		bake_curve();
+	}
+
+	return value * interpolate_baked(level);
+}
+
+void ScalableFloat::calculate_magnitudes(const double *normalised_levels, double *results, int count) {
+	if (curve.is_null()) {
+		std::fill(results, results + count, value);
+		return;
+	} else if (bake_resolution <= 0) {
+		for (int i = 0; i < count; i++) {
+			results[i] = value * curve->interpolate(normalised_levels[i]);
+		}
+		return;
+	}
+
+	if (!baked.load(std::memory_order_acquire)) {
+		bake_curve();
+	}
+
+	// Branch free so the loop can be vectorised.
+	auto samples = baked_curve.ptr();
+	auto resolution = static_cast<double>(bake_resolution);
+
+	for (int i = 0; i < count; i++) {
+		auto offset = CLAMP(normalised_levels[i], 0.0, 1.0) * resolution;
+		auto index = MIN(static_cast<int>(offset), bake_resolution - 1);
+		auto weight = offset - index;
+		results[i] = value * (samples[index] + (samples[index + 1] - samples[index]) * weight);
+	}
 }
 
 void ScalableFloat::set_value(double value) {
 	this->value = value;
+	emit_changed();
 }
 
 double ScalableFloat::get_value() const {
@@ -30,23 +130,78 @@ double ScalableFloat::get_value() const {
 }
 
 void ScalableFloat::set_curve(const Ref<Curve> &value) {
+	if (curve.is_valid() && curve->is_connected("changed", this, "_on_curve_changed")) {
+		curve->disconnect("changed", this, "_on_curve_changed");
+	}
+
 	curve = value;
+	baked.store(false, std::memory_order_release);
+	baked_curve.clear();
+
+	if (curve.is_valid()) {
+		curve->connect("changed", this, "_on_curve_changed");
+	}
+
+	emit_changed();
 }
 
 Ref<Curve> ScalableFloat::get_curve() const {
 	return curve;
 }
 
+void ScalableFloat::set_bake_resolution(int value) {
+	bake_resolution = MAX(value, 0);
+	baked.store(false, std::memory_order_release);
+	baked_curve.clear();
+}
+
+int ScalableFloat::get_bake_resolution() const {
+	return bake_resolution;
+}
+
+void ScalableFloat::bake_curve() {
+	MutexLock cache_lock(get_cache_mutex());
+
+	if (baked.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	baked_curve.resize(bake_resolution + 1);
+	auto samples = baked_curve.ptrw();
+
+	for (int i = 0; i <= bake_resolution; i++) {
+		samples[i] = curve->interpolate(static_cast<double>(i) / bake_resolution);
+	}
+
+	baked.store(true, std::memory_order_release);
+}
+
+double ScalableFloat::interpolate_baked(double normalised_level) const {
+	auto offset = CLAMP(normalised_level, 0.0, 1.0) * bake_resolution;
+	auto index = MIN(static_cast<int>(offset), bake_resolution - 1);
+	auto weight = offset - index;
+	return Math::lerp(baked_curve[index], baked_curve[index + 1], weight);
+}
+
+void ScalableFloat::_on_curve_changed() {
+	baked.store(false, std::memory_order_release);
+	baked_curve.clear();
+}
+
 void ScalableFloat::_bind_methods() {
 	/** Methods */
 	ClassDB::bind_method(D_METHOD("set_value", "value"), &ScalableFloat::set_value);
 	ClassDB::bind_method(D_METHOD("get_value"), &ScalableFloat::get_value);
 	ClassDB::bind_method(D_METHOD("set_curve", "value"), &ScalableFloat::set_curve);
 	ClassDB::bind_method(D_METHOD("get_curve"), &ScalableFloat::get_curve);
+	ClassDB::bind_method(D_METHOD("set_bake_resolution", "value"), &ScalableFloat::set_bake_resolution);
+	ClassDB::bind_method(D_METHOD("get_bake_resolution"), &ScalableFloat::get_bake_resolution);
+	ClassDB::bind_method(D_METHOD("_on_curve_changed"), &ScalableFloat::_on_curve_changed);
 
 	/** Properties */
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "value"), "set_value", "get_value");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "curve", PROPERTY_HINT_RESOURCE_TYPE, "Curve"), "set_curve", "get_curve");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "bake_resolution", PROPERTY_HINT_RANGE, "0,1024,1"), "set_bake_resolution", "get_bake_resolution");
 }
 
 double AttributeBasedFloat::calculate_magnitude(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) {
@@ -64,7 +219,14 @@ double AttributeBasedFloat::calculate_magnitude(const Node *source, const Node *
 		} break;
 	}
 
-	if (!origin) {
+	if (!origin || origin->get_attribute_set().is_null()) {
+		return 0.0;
+	}
+
+	auto &&attributes = origin->get_attribute_set();
+	auto index = backing_attribute.resolve(attributes.ptr());
+
+	if (index == GAMEPLAY_ATTRIBUTE_INVALID) {
 		return 0.0;
 	}
 
@@ -72,29 +234,30 @@ double AttributeBasedFloat::calculate_magnitude(const Node *source, const Node *
 
 	switch (attribute_calculation) {
 		case AttributeCalculation::CurrentValue: {
-			attribute_value = origin->get_current_attribute_value(backing_attribute);
+			attribute_value = attributes->get_current_value(index);
 		} break;
 		case AttributeCalculation::BaseValue: {
-			attribute_value = origin->get_base_attribute_value(backing_attribute);
+			attribute_value = attributes->get_base_value(index);
 		} break;
 		case AttributeCalculation::DeltaValue: {
-			auto attribute_data = origin->get_attribute_data(backing_attribute);
-			attribute_value = attribute_data->get_current_value() - attribute_data->get_base_value();
+			attribute_value = attributes->get_current_value(index) - attributes->get_base_value(index);
 		} break;
 		default: {
 			return 0.0;
 		} break;
 	}
 
-	auto coefficient_magnitude = coefficient.is_valid() ? coefficient->calculate_magnitude(source, target, effect, level, normalised_level) : 1.0;
-	auto pre_addition_magnitude = pre_multiply_addition.is_valid() ? pre_multiply_addition->calculate_magnitude(source, target, effect, level, normalised_level) : 0.0;
-	auto post_addition_magnitude = post_multiply_addition.is_valid() ? post_multiply_addition->calculate_magnitude(source, target, effect, level, normalised_level) : 0.0;
 	auto curve_value = attribute_curve.is_valid() ? attribute_curve->interpolate(level) : 1.0;
 
-	return coefficient_magnitude * (pre_addition_magnitude + attribute_value * curve_value) + post_addition_magnitude;
+	return get_program().evaluate(attribute_value * curve_value, normalised_level);
+}
+
+void AttributeBasedFloat::compile_program() {
+	compile_terms(coefficient, pre_multiply_addition, post_multiply_addition);
 }
 
 void AttributeBasedFloat::set_coefficient(const Ref<ScalableFloat> &value) {
+	release_term(coefficient);
 	coefficient = value;
 }
 
@@ -103,6 +266,7 @@ Ref<ScalableFloat> AttributeBasedFloat::get_coefficient() const {
 }
 
 void AttributeBasedFloat::set_pre_multiply_addition(const Ref<ScalableFloat> &value) {
+	release_term(pre_multiply_addition);
 	pre_multiply_addition = value;
 }
 
@@ -111,6 +275,7 @@ Ref<ScalableFloat> AttributeBasedFloat::get_pre_multiply_addition() const {
 }
 
 void AttributeBasedFloat::set_post_multiply_addition(const Ref<ScalableFloat> &value) {
+	release_term(post_multiply_addition);
 	post_multiply_addition = value;
 }
 
@@ -119,11 +284,11 @@ Ref<ScalableFloat> AttributeBasedFloat::get_post_multiply_addition() const {
 }
 
 void AttributeBasedFloat::set_backing_attribute(const StringName &value) {
-	backing_attribute = value;
+	backing_attribute.set_name(value);
 }
 
 StringName AttributeBasedFloat::get_backing_attribute() const {
-	return backing_attribute;
+	return backing_attribute.get_name();
 }
 
 void AttributeBasedFloat::set_attribute_curve(const Ref<Curve> &value) {
@@ -202,16 +367,29 @@ void AttributeBasedFloat::_bind_methods() {
 }
 
 double CustomCalculatedFloat::calculate_magnitude(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) {
-	if (script.is_null()) {
-		script = GameplayPtr<ScriptInstance>(custom_calculation_script->instance_create(this));
+	// Looked up on every call so replaced or unregistered calculators take effect right away.
+	if (native_calculator != StringName()) {
+		auto calculator = GameplayCalculatorRegistry::get_singleton()->get_magnitude_calculator(native_calculator);
+		if (!calculator) {
+			ERR_EXPLAIN("Native magnitude calculator is not registered: " + String(native_calculator));
+			ERR_FAIL_V(0.0);
+		}
+
+		return get_program().evaluate(calculator(source, target, effect, level, normalised_level), normalised_level);
+	}
+
+	if (!script_created.load(std::memory_order_acquire)) {
+		MutexLock cache_lock(get_cache_mutex());
+
+		if (!script_created.load(std::memory_order_relaxed)) {
+			script = GameplayPtr<ScriptInstance>(custom_calculation_script->instance_create(this));
+			script_created.store(true, std::memory_order_release);
+		}
 	}
 	if (script.is_valid()) {
-		auto coefficient_magnitude = coefficient.is_valid() ? coefficient->calculate_magnitude(source, target, effect, level, normalised_level) : 1.0;
-		auto pre_addition_magnitude = pre_multiply_addition.is_valid() ? pre_multiply_addition->calculate_magnitude(source, target, effect, level, normalised_level) : 0.0;
-		auto post_addition_magnitude = post_multiply_addition.is_valid() ? post_multiply_addition->calculate_magnitude(source, target, effect, level, normalised_level) : 0.0;
 		auto custom_magnitude = static_cast<double>(script->call("_execute", source, target, effect, level, normalised_level));
 
-		return coefficient_magnitude * (pre_addition_magnitude + custom_magnitude) + post_addition_magnitude;
+		return get_program().evaluate(custom_magnitude, normalised_level);
 	} else {
 		WARN_PRINTS("Could not instantiate custom magnitude calculation script: " + custom_calculation_script->get_path());
 	}
@@ -220,6 +398,7 @@ double CustomCalculatedFloat::calculate_magnitude(const Node *source, const Node
 }
 
 void CustomCalculatedFloat::set_coefficient(const Ref<ScalableFloat> &value) {
+	release_term(coefficient);
 	coefficient = value;
 }
 
@@ -228,6 +407,7 @@ Ref<ScalableFloat> CustomCalculatedFloat::get_coefficient() const {
 }
 
 void CustomCalculatedFloat::set_pre_multiply_addition(const Ref<ScalableFloat> &value) {
+	release_term(pre_multiply_addition);
 	pre_multiply_addition = value;
 }
 
@@ -236,6 +416,7 @@ Ref<ScalableFloat> CustomCalculatedFloat::get_pre_multiply_addition() const {
 }
 
 void CustomCalculatedFloat::set_post_multiply_addition(const Ref<ScalableFloat> &value) {
+	release_term(post_multiply_addition);
 	post_multiply_addition = value;
 }
 
@@ -251,6 +432,18 @@ Ref<Script> CustomCalculatedFloat::get_calculation_script() const {
 	return custom_calculation_script;
 }
 
+void CustomCalculatedFloat::set_native_calculator(const StringName &value) {
+	native_calculator = value;
+}
+
+StringName CustomCalculatedFloat::get_native_calculator() const {
+	return native_calculator;
+}
+
+void CustomCalculatedFloat::compile_program() {
+	compile_terms(coefficient, pre_multiply_addition, post_multiply_addition);
+}
+
 void CustomMagnitudeCalculator::_bind_methods() {
 	BIND_VMETHOD(MethodInfo(Variant::REAL, "_execute", PropertyInfo(Variant::OBJECT, "source"), PropertyInfo(Variant::OBJECT, "target"), PropertyInfo(Variant::OBJECT, "effect"), PropertyInfo(Variant::INT, "level"), PropertyInfo(Variant::REAL, "normalised_level")));
 }
@@ -265,10 +458,458 @@ void CustomCalculatedFloat::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_post_multiply_addition"), &CustomCalculatedFloat::get_post_multiply_addition);
 	ClassDB::bind_method(D_METHOD("set_calculation_script", "value"), &CustomCalculatedFloat::set_calculation_script);
 	ClassDB::bind_method(D_METHOD("get_calculation_script"), &CustomCalculatedFloat::get_calculation_script);
+	ClassDB::bind_method(D_METHOD("set_native_calculator", "value"), &CustomCalculatedFloat::set_native_calculator);
+	ClassDB::bind_method(D_METHOD("get_native_calculator"), &CustomCalculatedFloat::get_native_calculator);
 
 	/** Properties */
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "coefficient", PROPERTY_HINT_RESOURCE_TYPE, "ScalableFloat"), "set_coefficient", "get_coefficient");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "pre_multiply_addition", PROPERTY_HINT_RESOURCE_TYPE, "ScalableFloat"), "set_pre_multiply_addition", "get_pre_multiply_addition");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "post_multiply_addition", PROPERTY_HINT_RESOURCE_TYPE, "ScalableFloat"), "set_post_multiply_addition", "get_post_multiply_addition");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "custom_calculation_script", PROPERTY_HINT_RESOURCE_TYPE, "Script"), "set_calculation_script", "get_calculation_script");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "native_calculator"), "set_native_calculator", "get_native_calculator");
+}
+
+/** Recursive descent compiler from formula to bytecode, registers are allocated like a stack. */
+class ExpressionFloat::Compiler {
+public:
+	Compiler(const String &expression, Vector<Instruction> &bytecode, Vector<GameplayAttributeHandle> &attributes) :
+			expression(expression),
+			bytecode(bytecode),
+			attributes(attributes) {
+	}
+
+	/** Compiles the whole formula, returns an empty string on success. */
+	String compile() {
+		auto result = parse_expression();
+		skip_whitespace();
+
+		if (error.empty() && position < expression.length()) {
+			fail("Unexpected character");
+		}
+		if (error.empty()) {
+			materialise(result);
+		}
+
+		return error;
+	}
+
+private:
+	/** Result of a sub-expression, either a folded constant or a register. */
+	struct Operand {
+		bool constant = true;
+		double value = 0;
+		uint8_t reg = 0;
+	};
+
+	const String &expression;
+	Vector<Instruction> &bytecode;
+	Vector<GameplayAttributeHandle> &attributes;
+	/** Attribute name with origin prefix for each entry in attributes. */
+	Vector<String> attribute_keys;
+	String error;
+	int position = 0;
+	int registers = 0;
+
+	static bool is_identifier_start(CharType c) {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+	}
+
+	static bool is_digit(CharType c) {
+		return c >= '0' && c <= '9';
+	}
+
+	void fail(const String &message) {
+		if (error.empty()) {
+			error = message + " at position " + itos(position) + ".";
+		}
+		position = expression.length();
+	}
+
+	CharType peek() {
+		skip_whitespace();
+		return position < expression.length() ? expression[position] : 0;
+	}
+
+	bool accept(CharType c) {
+		if (peek() == c) {
+			position++;
+			return true;
+		}
+		return false;
+	}
+
+	void expect(CharType c) {
+		if (!accept(c)) {
+			fail(String("Expected '") + String::chr(c) + "'");
+		}
+	}
+
+	void skip_whitespace() {
+		while (position < expression.length() && expression[position] <= ' ') {
+			position++;
+		}
+	}
+
+	String parse_identifier() {
+		auto start = position;
+		while (position < expression.length() && (is_identifier_start(expression[position]) || is_digit(expression[position]))) {
+			position++;
+		}
+		return expression.substr(start, position - start);
+	}
+
+	uint8_t allocate() {
+		if (registers >= MAX_REGISTERS) {
+			fail("Expression is too complex");
+			return 0;
+		}
+		return static_cast<uint8_t>(registers++);
+	}
+
+	void materialise(Operand &operand) {
+		if (!operand.constant) {
+			return;
+		}
+
+		Instruction instruction;
+		instruction.opcode = Constant;
+		instruction.target = allocate();
+		instruction.value = operand.value;
+		bytecode.push_back(instruction);
+
+		operand.constant = false;
+		operand.reg = instruction.target;
+	}
+
+	Operand load(Opcode opcode, int attribute = 0) {
+		Instruction instruction;
+		instruction.opcode = opcode;
+		instruction.target = allocate();
+		instruction.attribute = attribute;
+		bytecode.push_back(instruction);
+
+		Operand result;
+		result.constant = false;
+		result.reg = instruction.target;
+		return result;
+	}
+
+	/** Folds the operation if all operands are constant, otherwise emits it into the lowest operand register. */
+	Operand emit(Opcode opcode, Operand *operands, int count) {
+		Operand result;
+
+		if (!error.empty()) {
+			return result;
+		}
+		if (std::all_of(operands, operands + count, [](const Operand &operand) { return operand.constant; })) {
+			double values[3] = {};
+			for (int i = 0; i < count; i++) {
+				values[i] = operands[i].value;
+			}
+			result.value = apply(opcode, values[0], values[1], values[2]);
+			return result;
+		}
+
+		Instruction instruction;
+		instruction.opcode = opcode;
+		instruction.target = MAX_REGISTERS;
+
+		for (int i = 0; i < count; i++) {
+			materialise(operands[i]);
+			instruction.operands[i] = operands[i].reg;
+			instruction.target = MIN(instruction.target, operands[i].reg);
+		}
+
+		bytecode.push_back(instruction);
+		registers -= count - 1;
+
+		result.constant = false;
+		result.reg = instruction.target;
+		return result;
+	}
+
+	Operand emit(Opcode opcode, Operand left, Operand right) {
+		Operand operands[] = { left, right };
+		return emit(opcode, operands, 2);
+	}
+
+	Operand parse_expression() {
+		auto result = parse_term();
+
+		while (error.empty()) {
+			if (accept('+')) {
+				result = emit(Add, result, parse_term());
+			} else if (accept('-')) {
+				result = emit(Subtract, result, parse_term());
+			} else {
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	Operand parse_term() {
+		auto result = parse_unary();
+
+		while (error.empty()) {
+			if (accept('*')) {
+				result = emit(Multiply, result, parse_unary());
+			} else if (accept('/')) {
+				result = emit(Divide, result, parse_unary());
+			} else {
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	Operand parse_unary() {
+		if (accept('-')) {
+			auto operand = parse_unary();
+			return emit(Negate, &operand, 1);
+		} else if (accept('+')) {
+			return parse_unary();
+		}
+
+		return parse_primary();
+	}
+
+	Operand parse_primary() {
+		auto c = peek();
+
+		if (accept('(')) {
+			auto result = parse_expression();
+			expect(')');
+			return result;
+		} else if (is_digit(c) || c == '.') {
+			return parse_number();
+		} else if (!is_identifier_start(c)) {
+			fail("Expected value");
+			return Operand();
+		}
+
+		auto name = parse_identifier();
+
+		if (name == "source" || name == "target") {
+			expect('.');
+			if (!is_identifier_start(peek())) {
+				fail("Expected attribute name");
+				return Operand();
+			}
+			return parse_attribute(name == "source" ? SourceAttribute : TargetAttribute, parse_identifier());
+		} else if (name == "level") {
+			return load(Level);
+		} else if (name == "normalised_level") {
+			return load(NormalisedLevel);
+		} else if (name == "pi") {
+			Operand result;
+			result.value = Math_PI;
+			return result;
+		} else if (accept('(')) {
+			return parse_call(name);
+		}
+
+		fail("Unknown identifier '" + name + "'");
+		return Operand();
+	}
+
+	Operand parse_number() {
+		auto start = position;
+		while (position < expression.length() && (is_digit(expression[position]) || expression[position] == '.')) {
+			position++;
+		}
+		if (position < expression.length() && (expression[position] == 'e' || expression[position] == 'E')) {
+			position++;
+			if (position < expression.length() && (expression[position] == '+' || expression[position] == '-')) {
+				position++;
+			}
+			while (position < expression.length() && is_digit(expression[position])) {
+				position++;
+			}
+		}
+
+		Operand result;
+		result.value = expression.substr(start, position - start).to_double();
+		return result;
+	}
+
+	Operand parse_attribute(Opcode opcode, const String &name) {
+		auto key = (opcode == SourceAttribute ? "source." : "target.") + name;
+		auto index = attribute_keys.find(key);
+
+		if (index == -1) {
+			GameplayAttributeHandle handle;
+			handle.set_name(name);
+			index = attributes.size();
+			attributes.push_back(handle);
+			attribute_keys.push_back(key);
+		}
+
+		return load(opcode, index);
+	}
+
+	Operand parse_call(const String &name) {
+		struct Builtin {
+			const char *name;
+			Opcode opcode;
+			int arguments;
+		};
+		static const Builtin builtins[] = {
+			{ "min", Min, 2 },
+			{ "max", Max, 2 },
+			{ "clamp", Clamp, 3 },
+			{ "abs", Abs, 1 },
+			{ "floor", Floor, 1 },
+			{ "ceil", Ceil, 1 },
+			{ "round", Round, 1 },
+			{ "sqrt", Sqrt, 1 },
+			{ "pow", Pow, 2 },
+			{ "lerp", Lerp, 3 }
+		};
+
+		auto builtin = std::find_if(std::begin(builtins), std::end(builtins), [&name](const Builtin &builtin) { return name == builtin.name; });
+		if (builtin == std::end(builtins)) {
+			fail("Unknown function '" + name + "'");
+			return Operand();
+		}
+
+		Operand operands[3];
+		for (int i = 0; i < builtin->arguments; i++) {
+			if (i > 0) {
+				expect(',');
+			}
+			operands[i] = parse_expression();
+		}
+		expect(')');
+
+		return emit(builtin->opcode, operands, builtin->arguments);
+	}
+};
+
+double ExpressionFloat::calculate_magnitude(const Node *source, const Node *target, const Ref<GameplayEffect> &, int64_t level, double normalised_level) {
+	if (bytecode.empty()) {
+		return 0.0;
+	}
+
+	auto attribute_set = [](const Node *node) -> const GameplayAttributeSet * {
+		auto system = dynamic_cast<const GameplayAbilitySystem *>(node);
+		return system ? system->get_attribute_set().ptr() : nullptr;
+	};
+	auto read_attribute = [this](const GameplayAttributeSet *set, int attribute) {
+		if (!set) {
+			return 0.0;
+		}
+		auto index = attributes[attribute].resolve(set);
+		return index == GAMEPLAY_ATTRIBUTE_INVALID ? 0.0 : set->get_current_value(index);
+	};
+
+	auto source_attributes = attribute_set(source);
+	auto target_attributes = attribute_set(target);
+	double registers[MAX_REGISTERS];
+	auto code = bytecode.ptr();
+
+	for (int i = 0, n = bytecode.size(); i < n; i++) {
+		auto &&instruction = code[i];
+
+		switch (instruction.opcode) {
+			case Constant: {
+				registers[instruction.target] = instruction.value;
+			} break;
+			case SourceAttribute: {
+				registers[instruction.target] = read_attribute(source_attributes, instruction.attribute);
+			} break;
+			case TargetAttribute: {
+				registers[instruction.target] = read_attribute(target_attributes, instruction.attribute);
+			} break;
+			case Level: {
+				registers[instruction.target] = static_cast<double>(level);
+			} break;
+			case NormalisedLevel: {
+				registers[instruction.target] = normalised_level;
+			} break;
+			default: {
+				auto operands = instruction.operands;
+				registers[instruction.target] = apply(instruction.opcode, registers[operands[0]], registers[operands[1]], registers[operands[2]]);
+			} break;
+		}
+	}
+
+	return registers[0];
+}
+
+double ExpressionFloat::apply(Opcode opcode, double a, double b, double c) {
+	switch (opcode) {
+		case Add:
+			return a + b;
+		case Subtract:
+			return a - b;
+		case Multiply:
+			return a * b;
+		case Divide:
+			return a / b;
+		case Negate:
+			return -a;
+		case Min:
+			return MIN(a, b);
+		case Max:
+			return MAX(a, b);
+		case Clamp:
+			return CLAMP(a, b, c);
+		case Abs:
+			return Math::abs(a);
+		case Floor:
+			return Math::floor(a);
+		case Ceil:
+			return Math::ceil(a);
+		case Round:
+			return Math::round(a);
+		case Sqrt:
+			return Math::sqrt(a);
+		case Pow:
+			return Math::pow(a, b);
+		case Lerp:
+			return Math::lerp(a, b, c);
+		default:
+			return 0.0;
+	}
+}
+
+void ExpressionFloat::set_expression(const String &value) {
+	expression = value;
+	bytecode.clear();
+	attributes.clear();
+	compile_error = String();
+
+	if (expression.strip_edges().empty()) {
+		return;
+	}
+
+	compile_error = Compiler(expression, bytecode, attributes).compile();
+
+	if (!compile_error.empty()) {
+		bytecode.clear();
+		attributes.clear();
+		ERR_EXPLAIN("Could not compile expression '" + expression + "': " + compile_error);
+		ERR_FAIL();
+	}
+}
+
+String ExpressionFloat::get_expression() const {
+	return expression;
+}
+
+String ExpressionFloat::get_compile_error() const {
+	return compile_error;
+}
+
+void ExpressionFloat::_bind_methods() {
+	/** Methods */
+	ClassDB::bind_method(D_METHOD("set_expression", "value"), &ExpressionFloat::set_expression);
+	ClassDB::bind_method(D_METHOD("get_expression"), &ExpressionFloat::get_expression);
+	ClassDB::bind_method(D_METHOD("get_compile_error"), &ExpressionFloat::get_compile_error);
+
+	/** Properties */
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "expression", PROPERTY_HINT_MULTILINE_TEXT), "set_expression", "get_expression");
 }
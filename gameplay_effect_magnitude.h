@@ -1,15 +1,41 @@
 #pragma once
 
+#include "gameplay_attribute.h"
+#include "gameplay_calculator.h"
 #include "gameplay_node.h"
 
 #include <core/resource.h>
 #include <core/script_language.h>
 #include <scene/resources/curve.h>
 
+#include <atomic>
+
 class GameplayAttribute;
 class GameplayAbilitySystem;
 class GameplayTagContainer;
 class GameplayEffect;
+class ScalableFloat;
+
+/** Flattened coefficient * (pre_multiply_addition + x) + post_multiply_addition, constant terms are folded. */
+struct GameplayMagnitudeProgram {
+	/** Scalable float term, folded into value if it does not depend on level. */
+	struct Term {
+		/** Folded constant value. */
+		double value = 0;
+		/** Scalable float evaluated per level, null if folded. */
+		ScalableFloat *scaled = nullptr;
+
+		double evaluate(double normalised_level) const;
+	};
+
+	Term coefficient{ 1.0, nullptr };
+	Term pre_multiply_addition;
+	Term post_multiply_addition;
+	/** All terms are folded, evaluation is straight arithmetic. */
+	bool constant = true;
+
+	double evaluate(double x, double normalised_level) const;
+};
 
 /** Base resource for magnitude calculations */
 class GAMEPLAY_ABILITIES_API GameplayEffectMagnitude : public GameplayResource {
@@ -22,7 +48,25 @@ public:
 	/** Has to be overridden, will otherwise return always 0. */
 	virtual double calculate_magnitude(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level);
 
+protected:
+	/** Returns the compiled program, compiling it on first use. */
+	const GameplayMagnitudeProgram &get_program();
+	/** Flattens the magnitude into program, default leaves it as identity. */
+	virtual void compile_program();
+	/** Folds the terms into program and recompiles whenever one of them changes. */
+	void compile_terms(const Ref<ScalableFloat> &coefficient, const Ref<ScalableFloat> &pre_multiply_addition, const Ref<ScalableFloat> &post_multiply_addition);
+	/** Stops tracking a term which is about to be replaced. */
+	void release_term(const Ref<ScalableFloat> &term);
+	void invalidate_program();
+
+	GameplayMagnitudeProgram program;
+
 private:
+	/** Set once program is compiled, read without locking by evaluations on world workers. */
+	std::atomic<bool> compiled{ false };
+
+	void _on_term_changed();
+
 	static void _bind_methods();
 };
 
@@ -36,21 +80,49 @@ public:
 
 	/** value * curve->interpolate(level) */
 	double calculate_magnitude(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) override;
+	/** Same as calculate_magnitude without dispatch, used by compiled programs. */
+	double evaluate(double normalised_level);
+	/** Evaluates count normalised levels at once. */
+	void calculate_magnitudes(const double *normalised_levels, double *results, int count);
 
 	void set_value(double value);
 	double get_value() const;
 	void set_curve(const Ref<Curve> &value);
 	Ref<Curve> get_curve() const;
+	void set_bake_resolution(int value);
+	int get_bake_resolution() const;
 
 private:
 	/** Flat value to use or multiply with curve level. */
 	double value = 0;
 	/** Curve graph for multiplication. */
 	Ref<Curve> curve;
+	/** Amount of intervals the curve is sampled with, 0 interpolates the curve exactly on every evaluation. Baking is opt-in as it approximates the curve linearly. */
+	int bake_resolution = 0;
+	/** Curve samples at uniform normalised levels, baked on first use. */
+	Vector<double> baked_curve;
+	/** Set once baked_curve is baked, read without locking by evaluations on world workers. */
+	std::atomic<bool> baked{ false };
+
+	void bake_curve();
+	double interpolate_baked(double normalised_level) const;
+	void _on_curve_changed();
 
 	static void _bind_methods();
 };
 
+inline double GameplayMagnitudeProgram::Term::evaluate(double normalised_level) const {
+	return scaled ? scaled->evaluate(normalised_level) : value;
+}
+
+inline double GameplayMagnitudeProgram::evaluate(double x, double normalised_level) const {
+	if (constant) {
+		return coefficient.value * (pre_multiply_addition.value + x) + post_multiply_addition.value;
+	}
+
+	return coefficient.evaluate(normalised_level) * (pre_multiply_addition.evaluate(normalised_level) + x) + post_multiply_addition.evaluate(normalised_level);
+}
+
 /** From where to get attribute values. */
 namespace AttributeOrigin {
 enum Type {
@@ -107,6 +179,9 @@ public:
 	void set_target_tag_filter(const Ref<GameplayTagContainer> &value);
 	Ref<GameplayTagContainer> get_target_tag_filter() const;
 
+protected:
+	void compile_program() override;
+
 private:
 	static constexpr auto ATTRIBUTE_ORIGIN_SOURCE = AttributeOrigin::Source;
 	static constexpr auto ATTRIBUTE_ORIGIN_TARGET = AttributeOrigin::Target;
@@ -123,7 +198,7 @@ private:
 	Ref<ScalableFloat> post_multiply_addition;
 
 	/** Attribute value to capture. */
-	StringName backing_attribute;
+	GameplayAttributeHandle backing_attribute;
 	/** Attribute value to capture. */
 	Ref<Curve> attribute_curve;
 	/** From where to get the attribute. */
@@ -155,7 +230,7 @@ class GAMEPLAY_ABILITIES_API CustomCalculatedFloat : public GameplayEffectMagnit
 public:
 	virtual ~CustomCalculatedFloat() = default;
 
-	/** coefficient * (pre_multiply_addition + script->calculate_magnitude(...)) + post_multiply_addition */
+	/** coefficient * (pre_multiply_addition + calculator(...)) + post_multiply_addition, calculator being native or a script */
 	double calculate_magnitude(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) override;
 
 	void set_coefficient(const Ref<ScalableFloat> &value);
@@ -166,6 +241,11 @@ public:
 	Ref<ScalableFloat> get_post_multiply_addition() const;
 	void set_calculation_script(const Ref<Script> &value);
 	Ref<Script> get_calculation_script() const;
+	void set_native_calculator(const StringName &value);
+	StringName get_native_calculator() const;
+
+protected:
+	void compile_program() override;
 
 private:
 	/** Coefficient for attribute added by pre multiplicative value. */
@@ -177,9 +257,88 @@ private:
 
 	/** Custom calculation script, has to extend CustomMagnitudeCalculator. */
 	Ref<Script> custom_calculation_script;
+	/** Name of a calculator in GameplayCalculatorRegistry, takes precedence over the script. */
+	StringName native_calculator;
 
 	/** Laze loaded script instance. Will be created at first usage and used henceforth. */
 	GameplayPtr<ScriptInstance> script = nullptr;
+	/** Set once script is created, read without locking by calls on world workers. */
+	std::atomic<bool> script_created{ false };
+
+	static void _bind_methods();
+};
+
+/**
+ * Magnitude computed from a formula such as "source.attack * 1.5 - target.defence * 0.5".
+ * Supports source.<attribute>, target.<attribute>, level, normalised_level, numbers, + - * / and parentheses
+ * as well as min, max, clamp, abs, floor, ceil, round, sqrt, pow and lerp.
+ * The formula is compiled once into register based bytecode with constant sub-expressions folded.
+ */
+class GAMEPLAY_ABILITIES_API ExpressionFloat : public GameplayEffectMagnitude {
+	GDCLASS(ExpressionFloat, GameplayEffectMagnitude);
+	OBJ_CATEGORY("GameplayAbilities");
+
+public:
+	virtual ~ExpressionFloat() = default;
+
+	/** Runs the compiled bytecode, returns 0 if the expression did not compile. */
+	double calculate_magnitude(const Node *source, const Node *target, const Ref<GameplayEffect> &effect, int64_t level, double normalised_level) override;
+
+	void set_expression(const String &value);
+	String get_expression() const;
+	/** Returns the compile error or an empty string if the expression compiled. */
+	String get_compile_error() const;
+
+private:
+	/** Amount of registers a single evaluation may use. */
+	static constexpr int MAX_REGISTERS = 32;
+
+	enum Opcode : uint8_t {
+		Constant,
+		SourceAttribute,
+		TargetAttribute,
+		Level,
+		NormalisedLevel,
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Negate,
+		Min,
+		Max,
+		Clamp,
+		Abs,
+		Floor,
+		Ceil,
+		Round,
+		Sqrt,
+		Pow,
+		Lerp
+	};
+
+	/** Single instruction writing into target from up to three operand registers. */
+	struct Instruction {
+		Opcode opcode = Constant;
+		uint8_t target = 0;
+		uint8_t operands[3] = {};
+		/** Index into attributes for attribute loads. */
+		int attribute = 0;
+		/** Value for constant loads. */
+		double value = 0;
+	};
+
+	class Compiler;
+
+	/** Formula as written. */
+	String expression;
+	/** Error of the last compilation. */
+	String compile_error;
+	/** Compiled instructions, result ends up in the first register. */
+	Vector<Instruction> bytecode;
+	/** Attributes referenced by the formula, resolved per schema. */
+	Vector<GameplayAttributeHandle> attributes;
+
+	static double apply(Opcode opcode, double a, double b, double c);
 
 	static void _bind_methods();
 };
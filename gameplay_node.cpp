@@ -5,6 +5,34 @@
 
 namespace {
 constexpr auto _on_delayed_execution = "_on_delayed_execution";
+
+thread_local GameplayCommandBuffer *current_command_buffer = nullptr;
+}
+
+GameplayCommandBuffer *GameplayCommandBuffer::get_current() {
+	return current_command_buffer;
+}
+
+void GameplayCommandBuffer::set_current(GameplayCommandBuffer *buffer) {
+	current_command_buffer = buffer;
+}
+
+void GameplayCommandBuffer::push(const Command &command) {
+	commands.push_back(command);
+}
+
+void GameplayCommandBuffer::flush() {
+	// Commands may record further commands into the same buffer.
+	for (int i = 0; i < commands.size(); i++) {
+		const auto command = commands[i];
+		command();
+	}
+
+	commands.clear();
+}
+
+bool GameplayCommandBuffer::empty() const {
+	return commands.empty();
 }
 
 Node *GameplayNode::_bind_find_child(const String &class_name) const {
@@ -81,6 +109,14 @@ void GameplayNode::deserialise(const Dictionary &data) {
 	}
 }
 
+void GameplayNode::defer_delete() {
+	if (auto buffer = GameplayCommandBuffer::get_current()) {
+		buffer->push([this] { queue_delete(); });
+	} else {
+		queue_delete();
+	}
+}
+
 void GameplayNode::_bind_methods() {
 	BIND_VMETHOD(MethodInfo(_on_delayed_execution, PropertyInfo(Variant::OBJECT, "args")));
 	ClassDB::bind_method(D_METHOD("find_child", "child_class"), &GameplayNode::_bind_find_child);
@@ -116,6 +152,11 @@ void GameplayResource::deserialise(const Dictionary &data) {
 	}
 }
 
+Mutex *GameplayResource::get_cache_mutex() {
+	static GameplayPtr<Mutex> mutex(Mutex::create());
+	return mutex.get();
+}
+
 void GameplayResource::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("serialise"), &GameplayResource::serialise);
 	ClassDB::bind_method(D_METHOD("deserialise", "data"), &GameplayResource::deserialise);
@@ -2,11 +2,35 @@
 
 #include "gameplay_api.h"
 
+#include <core/os/mutex.h>
 #include <core/os/thread.h>
 #include <core/resource.h>
 #include <core/vector.h>
 #include <scene/main/node.h>
 
+#include <functional>
+
+/**
+ * Commands recorded while ability systems tick on worker threads, replayed in order on the main thread.
+ * Anything touching the scene tree, signals or the message queue is recorded instead of executed.
+ */
+class GAMEPLAY_ABILITIES_API GameplayCommandBuffer {
+public:
+	typedef std::function<void()> Command;
+
+	/** Returns the buffer commands of the current thread are recorded into or null if they execute right away. */
+	static GameplayCommandBuffer *get_current();
+	static void set_current(GameplayCommandBuffer *buffer);
+
+	void push(const Command &command);
+	/** Executes recorded commands in order of recording and clears them. */
+	void flush();
+	bool empty() const;
+
+private:
+	Vector<Command> commands;
+};
+
 class GAMEPLAY_ABILITIES_API GameplayNode : public Node {
 	GDCLASS(GameplayNode, Node);
 	OBJ_CATEGORY("GameplayAbilities");
@@ -101,6 +125,29 @@ public:
 	Dictionary serialise() const;
 	void deserialise(const Dictionary &data);
 
+	/** Emits a signal or records it while ticking on a worker thread. */
+	template <class... Args>
+	void emit_gameplay_signal(const StringName &signal, const Args &... args) {
+		if (auto buffer = GameplayCommandBuffer::get_current()) {
+			buffer->push([=] { emit_signal(signal, args...); });
+		} else {
+			emit_signal(signal, args...);
+		}
+	}
+
+	/** Calls a method deferred or records the call while ticking on a worker thread. */
+	template <class... Args>
+	void defer_call(const StringName &method, const Args &... args) {
+		if (auto buffer = GameplayCommandBuffer::get_current()) {
+			buffer->push([=] { call_deferred(method, args...); });
+		} else {
+			call_deferred(method, args...);
+		}
+	}
+
+	/** Queues this node for deletion or records it while ticking on a worker thread. */
+	void defer_delete();
+
 private:
 	/** Bindings */
 	static void _bind_methods();
@@ -116,6 +163,13 @@ public:
 	Dictionary serialise() const;
 	void deserialise(const Dictionary &data);
 
+protected:
+	/**
+	 * Guards caches built lazily on first use, world workers may build them concurrently for resources they share.
+	 * Recursive so building a cache may build the caches of nested resources.
+	 */
+	static Mutex *get_cache_mutex();
+
 private:
 	/** Bindings */
 	static void _bind_methods();
@@ -1,14 +1,419 @@
 #include "gameplay_tags.h"
 
+#include <core/ucaps.h>
+
 #include <algorithm>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAMEPLAY_TAGS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+bool test_bit(const Vector<uint64_t> &bits, GameplayTagId id) {
+	auto word = static_cast<int>(id >> 6);
+	return word < bits.size() && ((bits[word] >> (id & 63)) & 1);
+}
+
+void set_bit(Vector<uint64_t> &bits, GameplayTagId id) {
+	auto word = static_cast<int>(id >> 6);
+
+	if (word >= bits.size()) {
+		auto size = bits.size();
+		bits.resize(word + 1);
+		std::fill(bits.ptrw() + size, bits.ptrw() + word + 1, 0);
+	}
+
+	bits.ptrw()[word] |= uint64_t(1) << (id & 63);
+}
+
+void clear_bit(Vector<uint64_t> &bits, GameplayTagId id) {
+	auto word = static_cast<int>(id >> 6);
+
+	if (word < bits.size()) {
+		bits.ptrw()[word] &= ~(uint64_t(1) << (id & 63));
+	}
+}
+
+/** Returns true if every bit of required is set in owned. */
+bool bits_has_all(const uint64_t *owned, int owned_words, const uint64_t *required, int required_words) {
+	int i = 0;
+	int n = MIN(owned_words, required_words);
+
+#if defined(__AVX2__)
+	for (; i + 4 <= n; i += 4) {
+		auto owned_chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(owned + i));
+		auto required_chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(required + i));
+		auto missing = _mm256_andnot_si256(owned_chunk, required_chunk);
+
+		if (!_mm256_testz_si256(missing, missing)) {
+			return false;
+		}
+	}
+#elif defined(GAMEPLAY_TAGS_SSE2)
+	for (; i + 2 <= n; i += 2) {
+		auto owned_chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(owned + i));
+		auto required_chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(required + i));
+		auto missing = _mm_andnot_si128(owned_chunk, required_chunk);
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) != 0xFFFF) {
+			return false;
+		}
+	}
+#endif
+
+	for (; i < n; i++) {
+		if (required[i] & ~owned[i]) {
+			return false;
+		}
+	}
+
+	// Words beyond the owned bitset can't be satisfied.
+	for (; i < required_words; i++) {
+		if (required[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** Returns true if any bit of queried is set in owned. */
+bool bits_has_any(const uint64_t *owned, int owned_words, const uint64_t *queried, int queried_words) {
+	int i = 0;
+	int n = MIN(owned_words, queried_words);
+
+#if defined(__AVX2__)
+	for (; i + 4 <= n; i += 4) {
+		auto owned_chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(owned + i));
+		auto queried_chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(queried + i));
+
+		if (!_mm256_testz_si256(owned_chunk, queried_chunk)) {
+			return true;
+		}
+	}
+#elif defined(GAMEPLAY_TAGS_SSE2)
+	for (; i + 2 <= n; i += 2) {
+		auto owned_chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(owned + i));
+		auto queried_chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(queried + i));
+		auto common = _mm_and_si128(owned_chunk, queried_chunk);
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(common, _mm_setzero_si128())) != 0xFFFF) {
+			return true;
+		}
+	}
+#endif
+
+	for (; i < n; i++) {
+		if (queried[i] & owned[i]) {
+			return true;
+		}
+	}
+
+	return false;
+}
+} // namespace
+
+GameplayTagRegistry *GameplayTagRegistry::singleton = nullptr;
+
+GameplayTagRegistry::GameplayTagRegistry() :
+		lock(RWLock::create()) {
+	entries.push_back(TagEntry());
+	singleton = this;
+}
+
+GameplayTagRegistry::~GameplayTagRegistry() {
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
+
+GameplayTagRegistry *GameplayTagRegistry::get_singleton() {
+	return singleton;
+}
+
+bool GameplayTagRegistry::is_wildcard(const String &tag) {
+	return tag.find("*") != -1 || tag.find("?") != -1;
+}
+
+GameplayTagId GameplayTagRegistry::intern(const String &tag) {
+	if (tag.empty() || is_wildcard(tag)) {
+		return GAMEPLAY_TAG_INVALID;
+	}
+
+	{
+		RWLockRead read_lock(lock.get());
+		if (auto id = spellings.getptr(tag)) {
+			return *id;
+		}
+	}
+
+	auto key = tag.to_lower();
+	RWLockWrite write_lock(lock.get());
+	auto id = intern_key(key, tag);
+	spellings.set(tag, id);
+	return id;
+}
+
+GameplayTagId GameplayTagRegistry::find(const String &tag) const {
+	if (tag.empty() || is_wildcard(tag)) {
+		return GAMEPLAY_TAG_INVALID;
+	}
+
+	RWLockRead read_lock(lock.get());
+
+	if (auto id = spellings.getptr(tag)) {
+		return *id;
+	}
+
+	auto id = lookup.getptr(tag.to_lower());
+	return id ? *id : GAMEPLAY_TAG_INVALID;
+}
+
+String GameplayTagRegistry::get_tag_name(GameplayTagId id) const {
+	RWLockRead read_lock(lock.get());
+	ERR_FAIL_INDEX_V(id, static_cast<GameplayTagId>(entries.size()), String());
+	return entries[id].name;
+}
+
+GameplayTagId GameplayTagRegistry::get_parent(GameplayTagId id) const {
+	RWLockRead read_lock(lock.get());
+	ERR_FAIL_INDEX_V(id, static_cast<GameplayTagId>(entries.size()), GAMEPLAY_TAG_INVALID);
+	return entries[id].parent;
+}
+
+int GameplayTagRegistry::get_depth(GameplayTagId id) const {
+	RWLockRead read_lock(lock.get());
+	ERR_FAIL_INDEX_V(id, static_cast<GameplayTagId>(entries.size()), 0);
+	return entries[id].depth;
+}
+
+bool GameplayTagRegistry::is_child_of(GameplayTagId id, GameplayTagId parent) const {
+	if (id == GAMEPLAY_TAG_INVALID || parent == GAMEPLAY_TAG_INVALID) {
+		return false;
+	}
+
+	RWLockRead read_lock(lock.get());
+	ERR_FAIL_INDEX_V(id, static_cast<GameplayTagId>(entries.size()), false);
+
+	for (auto current = entries[id].parent; current != GAMEPLAY_TAG_INVALID; current = entries[current].parent) {
+		if (current == parent) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int GameplayTagRegistry::get_tag_count() const {
+	RWLockRead read_lock(lock.get());
+	return entries.size() - 1;
+}
+
+GameplayTagId GameplayTagRegistry::intern_key(const String &key, const String &name) {
+	if (auto id = lookup.getptr(key)) {
+		return *id;
+	}
+
+	TagEntry entry;
+	entry.name = name;
+
+	auto separator = key.find_last(".");
+	if (separator > 0) {
+		entry.parent = intern_key(key.substr(0, separator), name.substr(0, separator));
+		entry.depth = entries[entry.parent].depth + 1;
+	}
+
+	auto id = static_cast<GameplayTagId>(entries.size());
+	entries.push_back(entry);
+	lookup.set(key, id);
+	spellings.set(name, id);
+	return id;
+}
+
+void GameplayTagRegistry::_bind_methods() {
+	/** Methods */
+	ClassDB::bind_method(D_METHOD("intern", "tag"), &GameplayTagRegistry::intern);
+	ClassDB::bind_method(D_METHOD("find", "tag"), &GameplayTagRegistry::find);
+	ClassDB::bind_method(D_METHOD("get_tag_name", "id"), &GameplayTagRegistry::get_tag_name);
+	ClassDB::bind_method(D_METHOD("get_parent", "id"), &GameplayTagRegistry::get_parent);
+	ClassDB::bind_method(D_METHOD("get_depth", "id"), &GameplayTagRegistry::get_depth);
+	ClassDB::bind_method(D_METHOD("is_child_of", "id", "parent"), &GameplayTagRegistry::is_child_of);
+	ClassDB::bind_method(D_METHOD("get_tag_count"), &GameplayTagRegistry::get_tag_count);
+}
+
+GameplayTagPattern::GameplayTagPattern(const String &pattern, bool intern /*= false*/) :
+		pattern(pattern) {
+	if (pattern.empty()) {
+		return;
+	}
+
+	// Interning a tag interns its parents, so no interned tag can match a pattern whose tag is unknown.
+	auto registry = GameplayTagRegistry::get_singleton();
+	auto resolve = [&](const String &tag) {
+		return intern ? registry->intern(tag) : registry->find(tag);
+	};
+
+	auto stars = 0;
+	auto questions = 0;
+
+	for (int i = 0, n = pattern.length(); i < n; i++) {
+		stars += pattern[i] == '*';
+		questions += pattern[i] == '?';
+	}
+
+	if (stars == 0 && questions == 0) {
+		kind = Exact;
+		id = resolve(pattern);
+		literal = pattern.to_upper();
+	} else if (questions == 0 && stars == 1 && pattern.length() == 1) {
+		kind = Any;
+	} else if (questions == 0 && stars == 1 && pattern.length() > 2 && pattern.ends_with(".*")) {
+		// Children of A.B share the prefix "A.B." as parents are split at the last dot.
+		kind = Descendants;
+		id = resolve(pattern.substr(0, pattern.length() - 2));
+		literal = pattern.substr(0, pattern.length() - 1).to_upper();
+	} else if (questions == 0 && stars == 1 && pattern.ends_with("*")) {
+		kind = Prefix;
+		literal = pattern.substr(0, pattern.length() - 1).to_upper();
+	} else if (questions == 0 && stars == 1 && pattern.begins_with("*")) {
+		kind = Suffix;
+		literal = pattern.substr(1, pattern.length() - 1).to_upper();
+	} else {
+		kind = Generic;
+		literal = pattern.to_upper();
+	}
+}
+
+bool GameplayTagPattern::match(const String &tag) const {
+	auto length = tag.length();
+
+	// Same as matchn, empty tags never match.
+	if (length == 0) {
+		return false;
+	}
+
+	switch (kind) {
+		case Exact: {
+			return length == literal.length() && match_literal(tag.c_str(), length);
+		}
+		case Any: {
+			return true;
+		}
+		case Descendants:
+		case Prefix: {
+			return length >= literal.length() && match_literal(tag.c_str(), literal.length());
+		}
+		case Suffix: {
+			return length >= literal.length() && match_literal(tag.c_str() + length - literal.length(), literal.length());
+		}
+		case Generic: {
+			return match_glob(tag.c_str());
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+bool GameplayTagPattern::is_empty() const {
+	return kind == Empty;
+}
+
+bool GameplayTagPattern::is_exact() const {
+	return kind == Exact;
+}
+
+bool GameplayTagPattern::is_descendants() const {
+	return kind == Descendants;
+}
+
+GameplayTagId GameplayTagPattern::get_id() const {
+	return id;
+}
+
+const String &GameplayTagPattern::get_pattern() const {
+	return pattern;
+}
+
+bool GameplayTagPattern::match_literal(const CharType *tag, int length) const {
+	auto upper = literal.c_str();
+
+	for (int i = 0; i < length; i++) {
+		if (_find_upper(tag[i]) != upper[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool GameplayTagPattern::match_glob(const CharType *tag) const {
+	auto glob = literal.c_str();
+	const CharType *star_glob = nullptr;
+	const CharType *star_tag = nullptr;
+
+	// Greedy matching with backtracking to the last star, '?' doesn't match '.' like matchn.
+	while (*tag) {
+		if (*glob == '*') {
+			star_glob = ++glob;
+			star_tag = tag;
+		} else if (*glob && (*glob == '?' ? *tag != '.' : _find_upper(*tag) == *glob)) {
+			glob++;
+			tag++;
+		} else if (star_glob) {
+			glob = star_glob;
+			tag = ++star_tag;
+		} else {
+			return false;
+		}
+	}
+
+	while (*glob == '*') {
+		glob++;
+	}
+
+	return *glob == 0;
+}
+
 bool GameplayTagContainer::has_tag(const String &tag) const {
 	if (tag.empty()) {
 		return true;
+	} else if (GameplayTagRegistry::is_wildcard(tag)) {
+		return has_tag_pattern(GameplayTagPattern(tag));
+	}
+
+	return has_tag_id(GameplayTagRegistry::get_singleton()->find(tag));
+}
+
+bool GameplayTagContainer::has_tag_id(GameplayTagId id) const {
+	return id != GAMEPLAY_TAG_INVALID && test_bit(tag_bits, id);
+}
+
+bool GameplayTagContainer::has_tag_pattern(const GameplayTagPattern &pattern) const {
+	if (pattern.is_empty()) {
+		return true;
+	} else if (pattern.is_exact()) {
+		return has_tag_id(pattern.get_id());
+	} else if (pattern.is_descendants()) {
+		if (has_descendant_id(pattern.get_id())) {
+			return true;
+		}
+
+		// Only owned wildcard entries are left to check.
+		for (int i = 0, n = pattern_count > 0 ? tags.size() : 0; i < n; i++) {
+			if (tag_ids[i] == GAMEPLAY_TAG_INVALID && pattern.match(tags[i])) {
+				return true;
+			}
+		}
+
+		return false;
 	}
 
 	for (auto &&owned_tag : tags) {
-		if (owned_tag.matchn(tag)) {
+		if (pattern.match(owned_tag)) {
 			return true;
 		}
 	}
@@ -16,32 +421,75 @@ bool GameplayTagContainer::has_tag(const String &tag) const {
 	return false;
 }
 
+bool GameplayTagContainer::has_tag_exact(const String &tag) const {
+	return has_tag_id(GameplayTagRegistry::get_singleton()->find(tag));
+}
+
+bool GameplayTagContainer::has_tag_hierarchical(const String &tag) const {
+	auto id = GameplayTagRegistry::get_singleton()->find(tag);
+	return has_tag_id(id) || has_descendant_id(id);
+}
+
+bool GameplayTagContainer::has_descendant_id(GameplayTagId id) const {
+	return id != GAMEPLAY_TAG_INVALID && test_bit(descendant_bits, id);
+}
+
 bool GameplayTagContainer::has_all(const Ref<GameplayTagContainer> &tags) const {
-	return std::all_of(begin(tags), end(tags), [this](const String &tag) {
-		return has_tag(tag);
-	});
+	if (!bits_has_all(tag_bits.ptr(), tag_bits.size(), tags->tag_bits.ptr(), tags->tag_bits.size())) {
+		return false;
+	}
+
+	// Wildcard entries can't be expressed as bits.
+	for (int i = 0, n = tags->pattern_count > 0 ? tags->size() : 0; i < n; i++) {
+		if (tags->tag_ids[i] == GAMEPLAY_TAG_INVALID && !has_tag_pattern(tags->tag_patterns[i])) {
+			return false;
+		}
+	}
+
+	return true;
 }
 
 bool GameplayTagContainer::has_any(const Ref<GameplayTagContainer> &tags) const {
-	return std::any_of(begin(tags), end(tags), [this](const String &tag) {
-		return has_tag(tag);
-	});
+	if (bits_has_any(tag_bits.ptr(), tag_bits.size(), tags->tag_bits.ptr(), tags->tag_bits.size())) {
+		return true;
+	}
+
+	// Wildcard entries can't be expressed as bits.
+	for (int i = 0, n = tags->pattern_count > 0 ? tags->size() : 0; i < n; i++) {
+		if (tags->tag_ids[i] == GAMEPLAY_TAG_INVALID && has_tag_pattern(tags->tag_patterns[i])) {
+			return true;
+		}
+	}
+
+	return false;
 }
 
 bool GameplayTagContainer::has_none(const Ref<GameplayTagContainer> &tags) const {
-	return std::none_of(begin(tags), end(tags), [this](const String &tag) {
-		return has_tag(tag);
-	});
+	return !has_any(tags);
 }
 
 void GameplayTagContainer::set_tag(int index, const String &value) {
+	ERR_FAIL_INDEX(index, tags.size());
+
+	auto id = GameplayTagRegistry::get_singleton()->intern(value);
+	auto previous = tag_ids[index];
+	pattern_count += (id == GAMEPLAY_TAG_INVALID) - (previous == GAMEPLAY_TAG_INVALID);
 	tags.set(index, value);
+	tag_ids.set(index, id);
+	tag_patterns.set(index, id == GAMEPLAY_TAG_INVALID ? GameplayTagPattern(value) : GameplayTagPattern());
+	remove_id(previous, index);
+	add_id(id, index);
 }
 
 const String &GameplayTagContainer::get_tag(int index) const {
 	return tags.read()[index];
 }
 
+GameplayTagId GameplayTagContainer::get_tag_id(int index) const {
+	ERR_FAIL_INDEX_V(index, tag_ids.size(), GAMEPLAY_TAG_INVALID);
+	return tag_ids[index];
+}
+
 int GameplayTagContainer::size() const {
 	return tags.size();
 }
@@ -52,40 +500,69 @@ bool GameplayTagContainer::empty() const {
 
 void GameplayTagContainer::append(const String &tag) {
 	if (!has_tag(tag)) {
-		tags.push_back(tag);
+		push_tag(tag);
 	}
 }
 
 void GameplayTagContainer::append_tags(const Ref<GameplayTagContainer> &tags) {
-	this->tags.append_array(tags->tags);
+	const auto array = tags->tags;
+	const auto ids = tags->tag_ids;
+	const auto patterns = tags->tag_patterns;
+
+	this->tags.append_array(array);
+	for (int i = 0, n = ids.size(); i < n; i++) {
+		tag_ids.push_back(ids[i]);
+		tag_patterns.push_back(patterns[i]);
+		add_id(ids[i], tag_ids.size() - 1);
+	}
+	pattern_count += tags->pattern_count;
 }
 
 void GameplayTagContainer::append_array(const PoolStringArray &array) {
-	tags.append_array(array);
+	for (int i = 0, n = array.size(); i < n; i++) {
+		push_tag(array[i]);
+	}
 }
 
 void GameplayTagContainer::remove(const String &tag) {
-	for (int i = tags.size() - 1; i >= 0; i--) {
-		if (tags[i].matchn(tag)) {
-			tags.remove(i);
+	if (GameplayTagRegistry::is_wildcard(tag)) {
+		GameplayTagPattern pattern(tag);
+
+		for (int i = tags.size() - 1; i >= 0; i--) {
+			if (pattern.match(tags[i])) {
+				remove_tag_at(i);
+			}
 		}
+	} else {
+		remove_tag_id(GameplayTagRegistry::get_singleton()->find(tag));
 	}
 }
 
-void GameplayTagContainer::remove_tags(const Ref<GameplayTagContainer> &tags) {
-	for (auto &&tag : tags) {
-		remove(tag);
+void GameplayTagContainer::remove_tag_id(GameplayTagId id) {
+	if (!has_tag_id(id)) {
+		return;
 	}
+
+	for (auto entry = references.getptr(id); entry && entry->entries > 0; entry = references.getptr(id)) {
+		remove_tag_at(entry->slot);
+	}
+}
+
+void GameplayTagContainer::remove_tags(const Ref<GameplayTagContainer> &tags) {
+	remove_array(tags->get_tags());
 }
 
 void GameplayTagContainer::remove_array(const PoolStringArray &array) {
-	for (int i = 0, n = array.size(); i < n; i++) {
-		remove(array[i]);
+	const auto copy = array;
+
+	for (int i = 0, n = copy.size(); i < n; i++) {
+		remove(copy[i]);
 	}
 }
 
 void GameplayTagContainer::set_tags(const PoolStringArray &value) {
 	tags = value;
+	rebuild_ids();
 }
 
 const PoolStringArray &GameplayTagContainer::get_tags() const {
@@ -96,28 +573,147 @@ String GameplayTagContainer::get_tag_list() {
 	return tags.join(",");
 }
 
-String &GameplayTagContainer::operator[](int index) {
-	return tags.write()[index];
-}
-
 const String &GameplayTagContainer::operator[](int index) const {
 	return tags.read()[index];
 }
 
+void GameplayTagContainer::push_tag(const String &tag) {
+	auto id = GameplayTagRegistry::get_singleton()->intern(tag);
+
+	tags.push_back(tag);
+	tag_ids.push_back(id);
+	tag_patterns.push_back(id == GAMEPLAY_TAG_INVALID ? GameplayTagPattern(tag) : GameplayTagPattern());
+	add_id(id, tags.size() - 1);
+
+	if (id == GAMEPLAY_TAG_INVALID) {
+		pattern_count++;
+	}
+}
+
+void GameplayTagContainer::remove_tag_at(int index) {
+	auto id = tag_ids[index];
+
+	if (id == GAMEPLAY_TAG_INVALID) {
+		pattern_count--;
+	}
+
+	auto last = tags.size() - 1;
+
+	if (index != last) {
+		tags.set(index, tags[last]);
+		tag_ids.set(index, tag_ids[last]);
+		tag_patterns.set(index, tag_patterns[last]);
+
+		if (auto moved = references.getptr(tag_ids[index])) {
+			if (moved->slot == last) {
+				moved->slot = index;
+			}
+		}
+	}
+
+	tags.resize(last);
+	tag_ids.resize(last);
+	tag_patterns.resize(last);
+	remove_id(id, index);
+}
+
+void GameplayTagContainer::rebuild_ids() {
+	auto registry = GameplayTagRegistry::get_singleton();
+
+	tag_ids.resize(tags.size());
+	tag_patterns.resize(tags.size());
+	tag_bits.clear();
+	descendant_bits.clear();
+	references.clear();
+	pattern_count = 0;
+
+	for (int i = 0, n = tags.size(); i < n; i++) {
+		auto id = registry->intern(tags[i]);
+		tag_ids.set(i, id);
+		tag_patterns.set(i, id == GAMEPLAY_TAG_INVALID ? GameplayTagPattern(tags[i]) : GameplayTagPattern());
+		add_id(id, i);
+
+		if (id == GAMEPLAY_TAG_INVALID) {
+			pattern_count++;
+		}
+	}
+}
+
+void GameplayTagContainer::add_id(GameplayTagId id, int index) {
+	if (id == GAMEPLAY_TAG_INVALID) {
+		return;
+	}
+
+	auto &&entry = references[id];
+
+	if (entry.entries++ == 0) {
+		entry.slot = index;
+		set_bit(tag_bits, id);
+	}
+
+	auto registry = GameplayTagRegistry::get_singleton();
+
+	for (auto parent = registry->get_parent(id); parent != GAMEPLAY_TAG_INVALID; parent = registry->get_parent(parent)) {
+		if (references[parent].descendants++ == 0) {
+			set_bit(descendant_bits, parent);
+		}
+	}
+}
+
+void GameplayTagContainer::remove_id(GameplayTagId id, int index) {
+	if (id == GAMEPLAY_TAG_INVALID) {
+		return;
+	}
+
+	auto entry = references.getptr(id);
+	ERR_FAIL_COND(!entry || entry->entries <= 0);
+
+	if (--entry->entries == 0) {
+		clear_bit(tag_bits, id);
+	} else if (entry->slot == index) {
+		// Only duplicate entries have to be searched for.
+		entry->slot = tag_ids.find(id);
+	}
+
+	if (entry->entries == 0 && entry->descendants == 0) {
+		references.erase(id);
+	}
+
+	auto registry = GameplayTagRegistry::get_singleton();
+
+	for (auto parent = registry->get_parent(id); parent != GAMEPLAY_TAG_INVALID; parent = registry->get_parent(parent)) {
+		auto parent_entry = references.getptr(parent);
+		ERR_CONTINUE(!parent_entry);
+
+		if (--parent_entry->descendants == 0) {
+			clear_bit(descendant_bits, parent);
+
+			if (parent_entry->entries == 0) {
+				references.erase(parent);
+			}
+		}
+	}
+}
+
 void GameplayTagContainer::_bind_methods() {
 	/** Methods */
 	ClassDB::bind_method(D_METHOD("has_tag", "tag"), &GameplayTagContainer::has_tag);
+	ClassDB::bind_method(D_METHOD("has_tag_id", "id"), &GameplayTagContainer::has_tag_id);
+	ClassDB::bind_method(D_METHOD("has_tag_exact", "tag"), &GameplayTagContainer::has_tag_exact);
+	ClassDB::bind_method(D_METHOD("has_tag_hierarchical", "tag"), &GameplayTagContainer::has_tag_hierarchical);
 	ClassDB::bind_method(D_METHOD("has_all", "tags"), &GameplayTagContainer::has_all);
 	ClassDB::bind_method(D_METHOD("has_any", "tags"), &GameplayTagContainer::has_any);
 	ClassDB::bind_method(D_METHOD("has_none", "tags"), &GameplayTagContainer::has_none);
 	ClassDB::bind_method(D_METHOD("set_tag", "index", "tag"), &GameplayTagContainer::set_tag);
 	ClassDB::bind_method(D_METHOD("get_tag", "index"), &GameplayTagContainer::get_tag);
+	ClassDB::bind_method(D_METHOD("get_tag_id", "index"), &GameplayTagContainer::get_tag_id);
 	ClassDB::bind_method(D_METHOD("size"), &GameplayTagContainer::size);
 	ClassDB::bind_method(D_METHOD("empty"), &GameplayTagContainer::empty);
 	ClassDB::bind_method(D_METHOD("append", "tag"), &GameplayTagContainer::append);
 	ClassDB::bind_method(D_METHOD("append_tags", "tag"), &GameplayTagContainer::append_tags);
 	ClassDB::bind_method(D_METHOD("append_array", "tag"), &GameplayTagContainer::append_array);
 	ClassDB::bind_method(D_METHOD("remove", "tag"), &GameplayTagContainer::remove);
+	ClassDB::bind_method(D_METHOD("remove_tag_id", "id"), &GameplayTagContainer::remove_tag_id);
 	ClassDB::bind_method(D_METHOD("remove_tags", "tag"), &GameplayTagContainer::remove_tags);
 	ClassDB::bind_method(D_METHOD("remove_array", "tag"), &GameplayTagContainer::remove_array);
 	ClassDB::bind_method(D_METHOD("set_tags", "value"), &GameplayTagContainer::set_tags);
@@ -128,10 +724,6 @@ void GameplayTagContainer::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::POOL_STRING_ARRAY, "tags"), "set_tags", "get_tags");
 }
 
-String *begin(Ref<GameplayTagContainer> &tags) {
-	return begin(tags->tags);
-}
-
 const String *begin(const Ref<GameplayTagContainer> &tags) {
 	return begin(tags->tags);
 }
@@ -140,10 +732,6 @@ const String *cbegin(const Ref<GameplayTagContainer> &tags) {
 	return cbegin(tags->tags);
 }
 
-String *end(Ref<GameplayTagContainer> &tags) {
-	return end(tags->tags);
-}
-
 const String *end(const Ref<GameplayTagContainer> &tags) {
 	return end(tags->tags);
 }
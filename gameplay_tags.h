@@ -2,28 +2,146 @@
 
 #include "gameplay_node.h"
 
+#include <core/hash_map.h>
+#include <core/object.h>
+#include <core/os/rw_lock.h>
 #include <core/resource.h>
 #include <core/variant.h>
 
+/** Interned tag identifier, dense and stable for the lifetime of the process. */
+typedef uint32_t GameplayTagId;
+
+/** Identifier for empty, wildcard or otherwise unknown tags. */
+constexpr GameplayTagId GAMEPLAY_TAG_INVALID = 0;
+
+/**
+ * Process wide registry which interns each tag string once into a compact identifier.
+ * Tags are treated case-insensitive and each dot separated segment registers its parent, e.g. A.B.C -> A.B -> A.
+ */
+class GAMEPLAY_ABILITIES_API GameplayTagRegistry : public Object {
+	GDCLASS(GameplayTagRegistry, Object);
+	OBJ_CATEGORY("GameplayAbilities");
+
+public:
+	GameplayTagRegistry();
+	virtual ~GameplayTagRegistry();
+
+	static GameplayTagRegistry *get_singleton();
+
+	/** Returns true if the tag contains glob characters and can't be interned. */
+	static bool is_wildcard(const String &tag);
+
+	/** Interns tag and all its parents, returns GAMEPLAY_TAG_INVALID for empty or wildcard tags. */
+	GameplayTagId intern(const String &tag);
+	/** Looks up tag without interning it. */
+	GameplayTagId find(const String &tag) const;
+
+	/** Returns the tag name as it was first interned. */
+	String get_tag_name(GameplayTagId id) const;
+	/** Returns the parent tag or GAMEPLAY_TAG_INVALID for root tags. */
+	GameplayTagId get_parent(GameplayTagId id) const;
+	/** Returns the amount of parents this tag has. */
+	int get_depth(GameplayTagId id) const;
+	/** Returns true if tag is a direct or indirect child of parent. */
+	bool is_child_of(GameplayTagId id, GameplayTagId parent) const;
+	/** Returns the amount of interned tags. */
+	int get_tag_count() const;
+
+private:
+	struct TagEntry {
+		/** Name as first interned. */
+		String name;
+		/** Parent tag of this one. */
+		GameplayTagId parent = GAMEPLAY_TAG_INVALID;
+		/** Amount of parents. */
+		int depth = 0;
+	};
+
+	static GameplayTagRegistry *singleton;
+
+	/** Entries indexed by tag id, first entry is reserved for invalid tags. */
+	Vector<TagEntry> entries;
+	/** Maps lower case tag names to their id. */
+	HashMap<String, GameplayTagId> lookup;
+	/** Maps tag names as they were interned to their id, looked up first so matching spellings aren't lowered. */
+	HashMap<String, GameplayTagId> spellings;
+	/** Guards registry access as tags can be interned at any time. */
+	GameplayPtr<RWLock> lock;
+
+	GameplayTagId intern_key(const String &key, const String &name);
+
+	static void _bind_methods();
+};
+
+/**
+ * Tag or wildcard pattern compiled once, matches a tag exactly like tag.matchn(pattern).
+ * Plain tags are looked up and compared without any glob logic, simple globs become prefix or suffix tests.
+ */
+class GAMEPLAY_ABILITIES_API GameplayTagPattern {
+public:
+	GameplayTagPattern() = default;
+	/** Query patterns only look up their tag, patterns used as index keys intern it so they get an id before the tag is first added. */
+	explicit GameplayTagPattern(const String &pattern, bool intern = false);
+
+	/** Returns true if tag matches this pattern. */
+	bool match(const String &tag) const;
+
+	/** Returns true if the pattern is an empty string. */
+	bool is_empty() const;
+	/** Returns true if the pattern contains no glob characters. */
+	bool is_exact() const;
+	/** Returns true if the pattern matches all children of a tag, e.g. A.B.* */
+	bool is_descendants() const;
+	/** Returns the id of exact patterns or the parent id of descendant patterns, GAMEPLAY_TAG_INVALID if the tag isn't interned. */
+	GameplayTagId get_id() const;
+	/** Returns the source string of this pattern. */
+	const String &get_pattern() const;
+
+private:
+	enum Kind {
+		Empty,
+		Exact,
+		Any,
+		Descendants,
+		Prefix,
+		Suffix,
+		Generic
+	};
+
+	Kind kind = Empty;
+	GameplayTagId id = GAMEPLAY_TAG_INVALID;
+	/** Source string of this pattern. */
+	String pattern;
+	/** Upper case literal or glob used for matching. */
+	String literal;
+
+	bool match_literal(const CharType *tag, int length) const;
+	bool match_glob(const CharType *tag) const;
+};
+
 class GAMEPLAY_ABILITIES_API GameplayTagContainer : public GameplayResource {
 	GDCLASS(GameplayTagContainer, GameplayResource);
 	OBJ_CATEGORY("GameplayAbilities");
 
-	friend String *begin(Ref<GameplayTagContainer> &tags);
 	friend const String *begin(const Ref<GameplayTagContainer> &tags);
 	friend const String *cbegin(const Ref<GameplayTagContainer> &tags);
-	friend String *end(Ref<GameplayTagContainer> &tags);
 	friend const String *end(const Ref<GameplayTagContainer> &tags);
 	friend const String *cend(const Ref<GameplayTagContainer> &tags);
 
 public:
 	bool has_tag(const String &tag) const;
+	bool has_tag_id(GameplayTagId id) const;
+	bool has_tag_pattern(const GameplayTagPattern &pattern) const;
+	bool has_tag_exact(const String &tag) const;
+	bool has_tag_hierarchical(const String &tag) const;
+	bool has_descendant_id(GameplayTagId id) const;
 	bool has_all(const Ref<GameplayTagContainer> &tags) const;
 	bool has_any(const Ref<GameplayTagContainer> &tags) const;
 	bool has_none(const Ref<GameplayTagContainer> &tags) const;
 
 	void set_tag(int index, const String &value);
 	const String &get_tag(int index) const;
+	GameplayTagId get_tag_id(int index) const;
 	int size() const;
 	bool empty() const;
 
@@ -31,6 +149,7 @@ public:
 	void append_tags(const Ref<GameplayTagContainer> &tags);
 	void append_array(const PoolStringArray &array);
 	void remove(const String &tag);
+	void remove_tag_id(GameplayTagId id);
 	void remove_tags(const Ref<GameplayTagContainer> &tags);
 	void remove_array(const PoolStringArray &array);
 
@@ -39,18 +158,43 @@ public:
 
 	String get_tag_list();
 
-	String &operator[](int index);
 	const String &operator[](int index) const;
 
 private:
 	PoolStringArray tags;
+	/** Interned ids parallel to tags, GAMEPLAY_TAG_INVALID for entries which have to be globbed. */
+	Vector<GameplayTagId> tag_ids;
+	/** Compiled patterns parallel to tags, only set for entries without a valid id. */
+	Vector<GameplayTagPattern> tag_patterns;
+	/** Amount of entries without a valid id. */
+	int pattern_count = 0;
+	/** Bitset of interned ids, one bit per id in chunks of 64. */
+	Vector<uint64_t> tag_bits;
+	/** Bitset of all strict parents of interned ids. */
+	Vector<uint64_t> descendant_bits;
+
+	/** Reference counts keeping the bits of an interned id alive. */
+	struct IdReferences {
+		/** Amount of entries with this id. */
+		int entries = 0;
+		/** Amount of entries with a descendant of this id. */
+		int descendants = 0;
+		/** Index of an entry with this id. */
+		int slot = -1;
+	};
+	HashMap<GameplayTagId, IdReferences> references;
+
+	void push_tag(const String &tag);
+	/** Swaps the entry with the last one before removing it, the order of remaining entries isn't kept. */
+	void remove_tag_at(int index);
+	void rebuild_ids();
+	void add_id(GameplayTagId id, int index);
+	void remove_id(GameplayTagId id, int index);
 
 	static void _bind_methods();
 };
 
-String *begin(Ref<GameplayTagContainer> &tags);
 const String *begin(const Ref<GameplayTagContainer> &tags);
 const String *cbegin(const Ref<GameplayTagContainer> &tags);
-String *end(Ref<GameplayTagContainer> &tags);
 const String *end(const Ref<GameplayTagContainer> &tags);
 const String *cend(const Ref<GameplayTagContainer> &tags);
@@ -2,9 +2,11 @@
 #include "gameplay_ability.h"
 #include "gameplay_ability_system.h"
 #include "gameplay_attribute.h"
+#include "gameplay_calculator.h"
 #include "gameplay_effect.h"
 #include "gameplay_effect_magnitude.h"
 #include "gameplay_tags.h"
+#include "gameplay_world.h"
 
 #include <core/class_db.h>
 #include <core/os/os.h>
@@ -268,6 +270,22 @@ public:
 	}
 };
 
+class AbilityReadyListener : public Object {
+	GDCLASS(AbilityReadyListener, Object);
+
+public:
+	int64_t ready_count = 0;
+
+	void _on_ability_ready(Object *source, Object *ability) {
+		ready_count++;
+	}
+
+private:
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("_on_ability_ready", "source", "ability"), &AbilityReadyListener::_on_ability_ready);
+	}
+};
+
 class CancellationAbility : public BaseTestAbility {
 public:
 	virtual ~CancellationAbility() = default;
@@ -910,6 +928,131 @@ SCENARIO("check ability cost") {
 	}
 }
 
+SCENARIO("abilities are activated by indexed tag triggers") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("abilities with exact and wildcard tag triggers") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// Source
+		auto source_attributes = make_reference<TestAttributeSet>();
+		auto source = make_gameplay_ptr<GameplayAbilitySystem>();
+		source->set_attribute_set(source_attributes);
+		root->add_child(source.get());
+
+		// Abilities
+		auto make_trigger = [](const String &tag) {
+			Array triggers;
+			triggers.append(make_reference<GameplayAbilityTriggerData>([&](Ref<GameplayAbilityTriggerData> trigger) {
+				trigger->set_trigger_tag(tag);
+				trigger->set_trigger_type(AbilityTrigger::OwnedTagAdded);
+			}));
+			return triggers;
+		};
+		auto wildcard_ability = make_gameplay_ptr<ApplyEffectAbility>();
+		auto exact_ability = make_gameplay_ptr<ApplyEffectAbility>();
+		wildcard_ability->set_triggers(make_trigger("trigger.status.*"));
+		source->add_ability(wildcard_ability.get());
+		source->add_ability(exact_ability.get());
+		exact_ability->set_triggers(make_trigger("trigger.other"));
+
+		WHEN("child of the wildcard trigger is added") {
+			source->add_tag("trigger.status.stun");
+
+			THEN("only the wildcard ability is activated") {
+				CHECK(wildcard_ability->is_active());
+				REQUIRE_FALSE(exact_ability->is_active());
+			}
+		}
+
+		WHEN("exact trigger tag is added") {
+			source->add_tag("Trigger.Other");
+
+			THEN("only the exact ability is activated") {
+				CHECK_FALSE(wildcard_ability->is_active());
+				REQUIRE(exact_ability->is_active());
+			}
+		}
+
+		WHEN("an event without matching triggers is handled") {
+			auto registry = GameplayTagRegistry::get_singleton();
+			auto tag_count = registry->get_tag_count();
+			auto event = make_reference<GameplayEvent>([](Ref<GameplayEvent> event) {
+				event->set_event_tag("trigger.unrelated.event");
+			});
+			auto handled = source->handle_event(event);
+
+			THEN("no ability is activated and no tag is interned by the lookup") {
+				CHECK_FALSE(handled);
+				CHECK_FALSE(wildcard_ability->is_active());
+				REQUIRE(registry->get_tag_count() == tag_count);
+			}
+		}
+	}
+}
+
+SCENARIO("waiting abilities are notified by subscription") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("attack ability waiting for an event") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// Source
+		auto source_attributes = make_reference<TestAttributeSet>();
+		auto source = make_gameplay_ptr<GameplayAbilitySystem>();
+		source->set_attribute_set(source_attributes);
+		source->add_tag("equipment.weapon");
+		root->add_child(source.get());
+
+		// Target
+		auto target_attributes = make_reference<TestAttributeSet>();
+		auto target = make_gameplay_ptr<GameplayAbilitySystem>();
+		target->set_attribute_set(target_attributes);
+		source->add_target(target.get());
+		root->add_child(target.get());
+
+		// Ability
+		auto ability = make_gameplay_ptr<AttackAbility>([](AttackAbility *ability) {
+			ability->wait_for_event = true;
+		});
+		source->add_ability(ability.get());
+		source->activate_ability(ability.get());
+		scene_tree->idle(delta);
+
+		WHEN("an unrelated event is handled") {
+			source->handle_event(make_reference<GameplayEvent>([](Ref<GameplayEvent> event) {
+				event->set_event_tag("event.other");
+			}));
+			scene_tree->idle(delta);
+
+			THEN("ability keeps waiting") {
+				CHECK(ability->is_active());
+				REQUIRE(ability->get_wait_handle().type == WaitType::Event);
+			}
+		}
+
+		WHEN("the awaited event is handled") {
+			source->handle_event(make_reference<GameplayEvent>([&](Ref<GameplayEvent> event) {
+				event->set_event_tag(ability->event_tag);
+			}));
+			scene_tree->idle(delta);
+
+			THEN("ability was committed") {
+				CHECK(!ability->is_active());
+				REQUIRE(target->get_current_attribute_value(health) == 90);
+			}
+		}
+	}
+}
+
 #pragma endregion
 
 #pragma region ability cancellation
@@ -1239,6 +1382,45 @@ SCENARIO("check ongoing tags are used for continuous effect execution") {
 	}
 }
 
+SCENARIO("active tags are reference counted", "[tags]") {
+	GIVEN("ability system with a tag added twice") {
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		auto tags = make_reference<GameplayTagContainer>([](Ref<GameplayTagContainer> tags) {
+			tags->append("counted.stun");
+			tags->append("counted.slow");
+		});
+		system->add_tags(tags);
+		system->add_tag("counted.stun");
+
+		WHEN("tag is removed once") {
+			system->remove_tag("counted.stun");
+
+			THEN("tag is still active and stored once") {
+				CHECK(system->get_active_tags()->size() == 2);
+				REQUIRE(system->get_active_tags()->has_tag("counted.stun"));
+			}
+		}
+
+		WHEN("tags are removed by wildcard") {
+			system->remove_tag("counted.*");
+
+			THEN("only the tag with a single reference is gone") {
+				CHECK(system->get_active_tags()->has_tag("counted.stun"));
+				REQUIRE_FALSE(system->get_active_tags()->has_tag("counted.slow"));
+			}
+		}
+
+		WHEN("all references are removed") {
+			system->remove_tags(tags);
+			system->remove_tag("counted.stun");
+
+			THEN("no tags are active") {
+				REQUIRE(system->get_active_tags()->empty());
+			}
+		}
+	}
+}
+
 #pragma endregion
 
 #pragma region effect modifiers
@@ -1346,6 +1528,52 @@ SCENARIO("scalable float magnitude should apply according to curve and level") {
 	}
 }
 
+SCENARIO("scalable float curves are baked into lookup tables", "[magnitudes]") {
+	GIVEN("scalable float with a non linear curve") {
+		auto curve = make_reference<Curve>([](Ref<Curve> curve) {
+			curve->add_point(Vector2(0, 0), 0, 0);
+			curve->add_point(Vector2(0.5, 0.8), 0, 0);
+			curve->add_point(Vector2(1, 1), 0, 0);
+		});
+		auto magnitude = make_reference<ScalableFloat>([&](Ref<ScalableFloat> magnitude) {
+			magnitude->set_value(100);
+			magnitude->set_curve(curve);
+		});
+		const double levels[] = { 0, 0.1, 0.25, 0.5, 0.65, 0.9, 1 };
+		constexpr auto count = sizeof(levels) / sizeof(levels[0]);
+
+		WHEN("nothing is configured") {
+			THEN("the curve is evaluated exactly") {
+				REQUIRE(magnitude->get_bake_resolution() == 0);
+			}
+		}
+
+		WHEN("evaluated baked and exact") {
+			magnitude->set_bake_resolution(256);
+			double baked[count];
+			magnitude->calculate_magnitudes(levels, baked, count);
+			magnitude->set_bake_resolution(0);
+
+			THEN("baked values stay within tolerance") {
+				for (size_t i = 0; i < count; i++) {
+					auto exact = magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 1, levels[i]);
+					REQUIRE(std::abs(baked[i] - exact) < 0.01);
+				}
+			}
+		}
+
+		WHEN("curve changes after baking") {
+			magnitude->set_bake_resolution(64);
+			magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 1, 0.5);
+			curve->set_point_value(1, 0.2);
+
+			THEN("table is baked again") {
+				REQUIRE(std::abs(magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 1, 0.5) - 20) < 0.01);
+			}
+		}
+	}
+}
+
 SCENARIO("attribute based magnitude should change according to attribute") {
 	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
 
@@ -1454,6 +1682,56 @@ SCENARIO("attribute based magnitude should change according to attribute") {
 	}
 }
 
+SCENARIO("constant magnitude terms are folded into programs", "[magnitudes]") {
+	GIVEN("attribute based magnitude with constant and scaled terms") {
+		auto source = make_gameplay_ptr<GameplayAbilitySystem>();
+		source->set_attribute_set(make_reference<TestAttributeSet>());
+
+		auto coefficient = make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+			magnitude->set_value(2);
+		});
+		auto magnitude = make_reference<AttributeBasedFloat>([&](Ref<AttributeBasedFloat> magnitude) {
+			magnitude->set_attribute_origin(AttributeOrigin::Source);
+			magnitude->set_backing_attribute(attack);
+			magnitude->set_coefficient(coefficient);
+			magnitude->set_pre_multiply_addition(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(10);
+			}));
+			magnitude->set_post_multiply_addition(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(5);
+			}));
+		});
+
+		WHEN("all terms are constant") {
+			THEN("folded program evaluates coefficient * (pre + attribute) + post") {
+				REQUIRE(magnitude->calculate_magnitude(source.get(), nullptr, Ref<GameplayEffect>(), 1, 0.5) == 225);
+			}
+		}
+
+		WHEN("a folded term changes after compilation") {
+			magnitude->calculate_magnitude(source.get(), nullptr, Ref<GameplayEffect>(), 1, 0.5);
+			coefficient->set_value(3);
+
+			THEN("program is compiled again") {
+				REQUIRE(magnitude->calculate_magnitude(source.get(), nullptr, Ref<GameplayEffect>(), 1, 0.5) == 335);
+			}
+		}
+
+		WHEN("a term is scaled by a curve") {
+			magnitude->calculate_magnitude(source.get(), nullptr, Ref<GameplayEffect>(), 1, 0.5);
+			coefficient->set_curve(make_reference<Curve>([](Ref<Curve> curve) {
+				curve->add_point(Vector2(0, 0), 0, 1);
+				curve->add_point(Vector2(1, 1), 1, 0);
+			}));
+
+			THEN("term is evaluated per level") {
+				REQUIRE(std::abs(magnitude->calculate_magnitude(source.get(), nullptr, Ref<GameplayEffect>(), 1, 0.5) - 115) < 0.01);
+				REQUIRE(std::abs(magnitude->calculate_magnitude(source.get(), nullptr, Ref<GameplayEffect>(), 1, 1) - 225) < 0.01);
+			}
+		}
+	}
+}
+
 SCENARIO("custom execution magnitude should do fancy stuff") {
 	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
 
@@ -1551,6 +1829,99 @@ SCENARIO("custom execution magnitude should do fancy stuff") {
 	}
 }
 
+SCENARIO("expression magnitudes evaluate compiled formulas", "[magnitudes]") {
+	GIVEN("source and target with attributes") {
+		auto source = make_gameplay_ptr<GameplayAbilitySystem>();
+		source->set_attribute_set(make_reference<TestAttributeSet>());
+		auto target = make_gameplay_ptr<GameplayAbilitySystem>();
+		target->set_attribute_set(make_reference<TestAttributeSet>([](Ref<TestAttributeSet> attributes) {
+			attributes->set_base_value(attributes->get_attribute_index(defence), 40);
+		}));
+		auto magnitude = make_reference<ExpressionFloat>();
+
+		WHEN("formula references source and target attributes") {
+			magnitude->set_expression("source.attack * 1.5 - target.defence * 0.5");
+
+			THEN("attributes are read from their origin") {
+				REQUIRE(magnitude->get_compile_error().empty());
+				REQUIRE(magnitude->calculate_magnitude(source.get(), target.get(), Ref<GameplayEffect>(), 1, 0) == 130);
+			}
+		}
+
+		WHEN("formula uses levels, builtins and constant sub-expressions") {
+			magnitude->set_expression("max(level * 10, 25) + clamp(normalised_level, 0, 0.5) * (2 + 3 * 4)");
+
+			THEN("result follows operator precedence") {
+				CHECK(magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 1, 1) == 32);
+				REQUIRE(magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 3, 0) == 30);
+			}
+		}
+
+		WHEN("formula is malformed") {
+			magnitude->set_expression("source.attack * (2 +");
+
+			THEN("compile error is reported and magnitude is zero") {
+				REQUIRE_FALSE(magnitude->get_compile_error().empty());
+				REQUIRE(magnitude->calculate_magnitude(source.get(), target.get(), Ref<GameplayEffect>(), 1, 0) == 0);
+			}
+		}
+	}
+}
+
+SCENARIO("native calculators replace calculation scripts", "[magnitudes]") {
+	GIVEN("calculators registered by name") {
+		auto registry = GameplayCalculatorRegistry::get_singleton();
+		registry->register_magnitude_calculator("test_level_times_ten", [](const Node *, const Node *, const Ref<GameplayEffect> &, int64_t level, double) {
+			return 10.0 * level;
+		});
+		registry->register_requirement_calculator("test_odd_level", [](const Node *, const Node *, const Ref<GameplayEffect> &, int64_t level, double) {
+			return level % 2 == 1;
+		});
+		auto _ = finally([registry] {
+			registry->unregister_calculator("test_level_times_ten");
+			registry->unregister_calculator("test_odd_level");
+		});
+
+		WHEN("custom calculated float references the magnitude calculator") {
+			auto magnitude = make_reference<CustomCalculatedFloat>([](Ref<CustomCalculatedFloat> magnitude) {
+				magnitude->set_native_calculator("test_level_times_ten");
+				magnitude->set_post_multiply_addition(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+					magnitude->set_value(5);
+				}));
+			});
+
+			THEN("calculator result is used without a script") {
+				REQUIRE(magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 3, 0.5) == 35);
+			}
+		}
+
+		WHEN("the calculator is replaced after its first use") {
+			auto magnitude = make_reference<CustomCalculatedFloat>([](Ref<CustomCalculatedFloat> magnitude) {
+				magnitude->set_native_calculator("test_level_times_ten");
+			});
+			magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 3, 0.5);
+			registry->register_magnitude_calculator("test_level_times_ten", [](const Node *, const Node *, const Ref<GameplayEffect> &, int64_t level, double) {
+				return 100.0 * level;
+			});
+
+			THEN("the replacement is used right away") {
+				REQUIRE(magnitude->calculate_magnitude(nullptr, nullptr, Ref<GameplayEffect>(), 3, 0.5) == 300);
+			}
+		}
+
+		WHEN("application requirement references the requirement calculator") {
+			auto requirement = make_reference<GameplayEffectCustomApplicationRequirement>([](Ref<GameplayEffectCustomApplicationRequirement> requirement) {
+				requirement->set_native_calculator("test_odd_level");
+			});
+
+			THEN("calculator decides the requirement") {
+				CHECK(requirement->execute(nullptr, nullptr, Ref<GameplayEffect>(), 1, 0));
+				REQUIRE_FALSE(requirement->execute(nullptr, nullptr, Ref<GameplayEffect>(), 2, 0));
+			}
+		}
+	}
+}
+
 #pragma endregion
 
 #pragma region effect executions
@@ -1721,6 +2092,1224 @@ SCENARIO("stack aggregation", "[stacking]") {
 	}
 }
 
+SCENARIO("aggregated modifiers are removed with their stacks", "[stacking]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("effect adding attack per execution") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto attributes = make_reference<TestAttributeSet>();
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(attributes);
+		root->add_child(system.get());
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test.stacked_effect");
+			effect->set_duration_type(DurationType::Infinite);
+			effect->set_stacking_type(StackingType::AggregateOnTarget);
+			effect->set_maximum_stacks(5);
+
+			Array modifiers;
+			modifiers.append(make_reference<GameplayEffectModifier>([](Ref<GameplayEffectModifier> modifier) {
+				modifier->set_attribute(attack);
+				modifier->set_modifier_operation(ModifierOperation::Add);
+				modifier->set_modifier_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+					magnitude->set_value(10);
+				}));
+			}));
+			effect->set_modifiers(modifiers);
+		});
+
+		WHEN("stacks are applied one, three and one at a time") {
+			system->apply_effect(system.get(), effect);
+			scene_tree->idle(delta);
+			system->apply_effect(system.get(), effect, 3);
+			scene_tree->idle(delta);
+			system->apply_effect(system.get(), effect);
+			scene_tree->idle(delta);
+
+			THEN("an execution is removed once all stacks it was applied for are gone") {
+				CHECK(system->get_stack_count(effect) == 5);
+				CHECK(system->get_current_attribute_value(attack) == 130);
+				system->remove_effect(system.get(), effect);
+				scene_tree->idle(delta);
+				CHECK(system->get_current_attribute_value(attack) == 120);
+				system->remove_effect(system.get(), effect, 2);
+				scene_tree->idle(delta);
+				CHECK(system->get_current_attribute_value(attack) == 120);
+				system->remove_effect(system.get(), effect);
+				scene_tree->idle(delta);
+				CHECK(system->get_current_attribute_value(attack) == 110);
+				system->apply_effect(system.get(), effect);
+				scene_tree->idle(delta);
+				REQUIRE(system->get_current_attribute_value(attack) == 120);
+			}
+		}
+	}
+}
+
+#pragma region effect lifecycle
+
+SCENARIO("ended effects are recycled by their system", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("system with an infinite effect") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto attributes = make_reference<TestAttributeSet>();
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(attributes);
+		root->add_child(system.get());
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_pooled_effect");
+			effect->set_duration_type(DurationType::Infinite);
+			effect->get_effect_tags()->append("test.pooled");
+			effect->get_target_tags()->append("pooled");
+		});
+
+		system->apply_effect(system.get(), effect);
+		scene_tree->idle(delta);
+
+		auto effects = system->query_active_effects_by_tag("test.pooled");
+		REQUIRE(effects.size() == 1);
+		auto effect_node = static_cast<GameplayEffectNode *>(static_cast<Node *>(effects[0]));
+
+		WHEN("effect gets removed") {
+			system->remove_effect(system.get(), effect);
+
+			THEN("its proxy is invalidated") {
+				CHECK(!effect_node->is_valid());
+				CHECK(effect_node->get_effect().is_null());
+				REQUIRE(system->query_active_effects_by_tag("test.pooled").empty());
+			}
+		}
+
+		WHEN("effect gets removed and applied again") {
+			system->remove_effect(system.get(), effect);
+			scene_tree->idle(delta);
+			system->apply_effect(system.get(), effect);
+			scene_tree->idle(delta);
+
+			THEN("recycled record is active again") {
+				auto reapplied = system->query_active_effects_by_tag("test.pooled");
+				CHECK(reapplied.size() == 1);
+				CHECK(static_cast<GameplayEffectNode *>(static_cast<Node *>(reapplied[0]))->is_valid());
+				REQUIRE(system->get_active_tags()->has_tag("pooled"));
+			}
+		}
+	}
+}
+
+SCENARIO("instant effects execute synchronously", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("system and an instant damage effect") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto attributes = make_reference<TestAttributeSet>();
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(attributes);
+		root->add_child(system.get());
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_instant_effect");
+			effect->set_stacking_type(StackingType::AggregateOnTarget);
+			effect->get_effect_tags()->append("test.instant");
+
+			Array modifiers;
+			modifiers.append(make_reference<GameplayEffectModifier>([](Ref<GameplayEffectModifier> modifier) {
+				modifier->set_attribute(health);
+				modifier->set_modifier_operation(ModifierOperation::Subtract);
+				modifier->set_modifier_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+					magnitude->set_value(10);
+				}));
+			}));
+			effect->set_modifiers(modifiers);
+		});
+
+		WHEN("effect is applied twice") {
+			system->apply_effect(system.get(), effect);
+			system->apply_effect(system.get(), effect);
+
+			THEN("health changes without waiting for the next frame") {
+				CHECK(system->get_current_attribute_value(health) == 80);
+				CHECK(system->get_base_attribute_value(health) == 100);
+				CHECK(system->get_stack_count(effect) == 0);
+				REQUIRE(system->query_active_effects_by_tag("test.instant").empty());
+			}
+		}
+	}
+}
+
+SCENARIO("infliction chances are rolled from seeded streams", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("two systems with the same seed and an effect with half infliction chance") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// Systems
+		auto first = make_gameplay_ptr<GameplayAbilitySystem>([](GameplayAbilitySystem *system) {
+			system->set_attribute_set(make_reference<TestAttributeSet>());
+			system->set_random_seed(1234);
+		});
+		auto second = make_gameplay_ptr<GameplayAbilitySystem>([](GameplayAbilitySystem *system) {
+			system->set_attribute_set(make_reference<TestAttributeSet>());
+			system->set_random_seed(1234);
+		});
+		root->add_child(first.get());
+		root->add_child(second.get());
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_infliction_chance(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(0.5);
+			}));
+
+			Array modifiers;
+			modifiers.append(make_reference<GameplayEffectModifier>([](Ref<GameplayEffectModifier> modifier) {
+				modifier->set_attribute(health);
+				modifier->set_modifier_operation(ModifierOperation::Subtract);
+				modifier->set_modifier_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+					magnitude->set_value(1);
+				}));
+			}));
+			effect->set_modifiers(modifiers);
+		});
+
+		WHEN("effect is applied repeatedly to both") {
+			for (int i = 0; i < 64; i++) {
+				first->apply_effect(first.get(), effect);
+				second->apply_effect(second.get(), effect);
+			}
+
+			THEN("both roll the same outcomes") {
+				auto health_lost = 100 - first->get_current_attribute_value(health);
+				CHECK(first->get_random_sequence() == 64);
+				CHECK(health_lost > 0);
+				CHECK(health_lost < 64);
+				REQUIRE(second->get_current_attribute_value(health) == first->get_current_attribute_value(health));
+			}
+		}
+
+		WHEN("stream of one is restored on the other through its properties") {
+			for (int i = 0; i < 32; i++) {
+				first->apply_effect(first.get(), effect);
+			}
+			second->set("random_seed", first->get("random_seed"));
+			second->set("random_sequence", first->get("random_sequence"));
+
+			THEN("other continues where the stream left off") {
+				CHECK(uint64_t(second->get("random_seed")) == 1234);
+				REQUIRE(second->get_random_sequence() == 32);
+			}
+		}
+	}
+}
+
+SCENARIO("active effects are indexed by definition and tag", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("system with several infinite auras") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(make_reference<TestAttributeSet>());
+		root->add_child(system.get());
+
+		auto make_aura = [](const String &name, const String &tag) {
+			return make_reference<GameplayEffect>([&](Ref<GameplayEffect> effect) {
+				effect->set_effect_name(name);
+				effect->set_duration_type(DurationType::Infinite);
+				effect->get_effect_tags()->append(tag);
+			});
+		};
+		auto fire = make_aura("test_fire_aura", "aura.fire");
+		auto frost = make_aura("test_frost_aura", "aura.frost");
+		auto haste = make_aura("test_haste", "buff.haste");
+
+		system->apply_effect(system.get(), frost);
+		system->apply_effect(system.get(), fire);
+		system->apply_effect(system.get(), haste);
+		scene_tree->idle(delta);
+
+		auto auras = make_reference<GameplayTagContainer>([](Ref<GameplayTagContainer> tags) {
+			tags->append("aura.fire");
+			tags->append("aura.frost");
+		});
+
+		WHEN("querying by tags") {
+			auto by_tag = system->query_active_effects_by_tag("aura.fire");
+			auto by_tags = system->query_active_effects(auras);
+
+			THEN("matching effects are returned in order of activation") {
+				REQUIRE(by_tag.size() == 1);
+				CHECK(static_cast<GameplayEffectNode *>(static_cast<Node *>(by_tag[0]))->get_effect() == fire);
+				REQUIRE(by_tags.size() == 2);
+				CHECK(static_cast<GameplayEffectNode *>(static_cast<Node *>(by_tags[0]))->get_effect() == frost);
+				REQUIRE(static_cast<GameplayEffectNode *>(static_cast<Node *>(by_tags[1]))->get_effect() == fire);
+			}
+		}
+
+		WHEN("an effect is removed") {
+			system->remove_effect(system.get(), fire);
+
+			THEN("it is dropped from every index") {
+				CHECK(system->query_active_effects_by_tag("aura.fire").empty());
+				CHECK(system->query_active_effects(auras).size() == 1);
+				REQUIRE(system->query_active_effects_by_tag("buff.haste").size() == 1);
+			}
+		}
+	}
+}
+
+SCENARIO("application immunities are reference counted", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("two effects granting the same immunity and one granting a wildcard immunity") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(make_reference<TestAttributeSet>());
+		root->add_child(system.get());
+
+		auto make_ward = [](const String &name, const String &immunity) {
+			return make_reference<GameplayEffect>([&](Ref<GameplayEffect> effect) {
+				effect->set_effect_name(name);
+				effect->set_duration_type(DurationType::Infinite);
+				effect->get_application_immunity_tags()->append(immunity);
+			});
+		};
+		auto make_threat = [](const String &tag) {
+			return make_reference<GameplayEffect>([&](Ref<GameplayEffect> effect) {
+				effect->set_duration_type(DurationType::Infinite);
+				effect->get_effect_tags()->append(tag);
+			});
+		};
+		auto first_ward = make_ward("test_first_ward", "threat.fire");
+		auto second_ward = make_ward("test_second_ward", "threat.fire");
+		auto curse_ward = make_ward("test_curse_ward", "curse.*");
+		auto fire = make_threat("threat.fire");
+		auto curse = make_threat("curse.weakness");
+
+		system->apply_effect(system.get(), first_ward);
+		system->apply_effect(system.get(), second_ward);
+		system->apply_effect(system.get(), curse_ward);
+		scene_tree->idle(delta);
+
+		WHEN("all wards are active") {
+			THEN("matching effects are denied") {
+				CHECK(!system->can_apply_effect(system.get(), fire));
+				REQUIRE(!system->can_apply_effect(system.get(), curse));
+			}
+		}
+
+		WHEN("one of the shared wards ends") {
+			system->remove_effect(system.get(), first_ward);
+
+			THEN("immunity is still granted by the other") {
+				REQUIRE(!system->can_apply_effect(system.get(), fire));
+			}
+		}
+
+		WHEN("every ward ends") {
+			system->remove_effect(system.get(), first_ward);
+			system->remove_effect(system.get(), second_ward);
+			system->remove_effect(system.get(), curse_ward);
+
+			THEN("effects can be applied again") {
+				CHECK(system->can_apply_effect(system.get(), fire));
+				REQUIRE(system->can_apply_effect(system.get(), curse));
+			}
+		}
+	}
+}
+
+SCENARIO("cooldowns are tracked by tag and signal readiness once", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("an ability with a cooldown of 10 and a listener for ready abilities") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(make_reference<TestAttributeSet>());
+		root->add_child(system.get());
+
+		// Ability
+		auto ability = make_gameplay_ptr<AttackAbility>();
+		system->add_ability(ability.get());
+		auto &&cooldown_effect = ability->get_cooldown_effect();
+
+		// Listener
+		auto listener = make_gameplay_ptr<AbilityReadyListener>();
+		system->connect("gameplay_ability_ready", listener.get(), "_on_ability_ready");
+
+		system->apply_effect(system.get(), cooldown_effect);
+		scene_tree->idle(delta);
+
+		WHEN("the cooldown is partially elapsed") {
+			THEN("the remaining cooldown is read from the cooldown table") {
+				CHECK(system->get_remaining_cooldown(cooldown_effect->get_effect_tags()) == 4);
+				CHECK(ability->get_remaining_cooldown() == 4);
+				REQUIRE(listener->ready_count == 0);
+			}
+		}
+
+		WHEN("the cooldown is refreshed by applying it again") {
+			system->remove_effect(system.get(), cooldown_effect);
+			system->apply_effect(system.get(), cooldown_effect);
+			scene_tree->idle(delta);
+
+			THEN("the cooldown restarts without the ability becoming ready") {
+				CHECK(ability->get_remaining_cooldown() == 4);
+				REQUIRE(listener->ready_count == 0);
+			}
+		}
+
+		WHEN("the cooldown expires and further updates pass") {
+			scene_tree->idle(delta);
+			scene_tree->idle(delta);
+			scene_tree->idle(delta);
+
+			THEN("the ability is ready and was signalled exactly once") {
+				CHECK(ability->get_remaining_cooldown() == 0);
+				REQUIRE(listener->ready_count == 1);
+			}
+		}
+	}
+}
+
+SCENARIO("effect durations are scheduled as deadlines", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("system with an effect lasting ten seconds") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto attributes = make_reference<TestAttributeSet>();
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(attributes);
+		root->add_child(system.get());
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_timed_effect");
+			effect->set_duration_type(DurationType::HasDuration);
+			effect->set_duration_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(10);
+			}));
+			effect->get_target_tags()->append("timed");
+		});
+
+		system->apply_effect(system.get(), effect);
+		scene_tree->idle(delta);
+
+		WHEN("less time than its duration passed") {
+			THEN("remaining duration is derived from its deadline") {
+				CHECK(system->get_active_tags()->has_tag("timed"));
+				REQUIRE(system->get_remaining_effect_duration(effect) == 4.0);
+			}
+		}
+
+		WHEN("its deadline passed") {
+			scene_tree->idle(delta);
+
+			THEN("effect has ended") {
+				CHECK(!system->get_active_tags()->has_tag("timed"));
+				REQUIRE(system->get_remaining_effect_duration(effect) == 0.0);
+			}
+		}
+	}
+
+	GIVEN("system with a long effect refreshed by every stack") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto attributes = make_reference<TestAttributeSet>();
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(attributes);
+		root->add_child(system.get());
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_refreshed_effect");
+			effect->set_duration_type(DurationType::HasDuration);
+			effect->set_duration_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(1000);
+			}));
+			effect->set_stacking_type(StackingType::AggregateOnTarget);
+			effect->set_maximum_stacks(200);
+			effect->get_target_tags()->append("refreshed");
+		});
+
+		// Every refresh leaves a deadline behind which is only due long after
+		for (int i = 0; i < 200; i++) {
+			system->apply_effect(system.get(), effect);
+			scene_tree->idle(delta);
+		}
+
+		WHEN("it was refreshed more often than deadlines are kept") {
+			THEN("effect keeps the duration of its last refresh") {
+				CHECK(system->get_stack_count(effect) == 200);
+				CHECK(system->get_active_tags()->has_tag("refreshed"));
+				REQUIRE(system->get_remaining_effect_duration(effect) > 990.0);
+			}
+		}
+
+		WHEN("the deadline of its last refresh passed") {
+			for (int i = 0; i < 1000 / delta + 1; i++) {
+				scene_tree->idle(delta);
+			}
+
+			THEN("effect has ended") {
+				CHECK(!system->get_active_tags()->has_tag("refreshed"));
+				REQUIRE(system->get_remaining_effect_duration(effect) == 0.0);
+			}
+		}
+	}
+}
+
+SCENARIO("world processed systems are ticked by the world", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("a world processed system with an effect lasting ten seconds") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto world = GameplayWorld::get_singleton();
+		auto system_count = world->get_system_count();
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(make_reference<TestAttributeSet>());
+		system->set_world_processing(true);
+		root->add_child(system.get());
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_world_effect");
+			effect->set_duration_type(DurationType::HasDuration);
+			effect->set_duration_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(10);
+			}));
+		});
+
+		system->apply_effect(system.get(), effect);
+		scene_tree->idle(delta);
+
+		WHEN("only the scene tree processed") {
+			THEN("the system registered with the world and ignored its process notification") {
+				CHECK(world->get_system_count() == system_count + 1);
+				REQUIRE(system->get_remaining_effect_duration(effect) == 10.0);
+			}
+		}
+
+		WHEN("the world processed") {
+			world->process(delta);
+
+			THEN("the effect advanced") {
+				REQUIRE(system->get_remaining_effect_duration(effect) == 4.0);
+			}
+		}
+
+		WHEN("the system left the tree") {
+			root->remove_child(system.get());
+
+			THEN("the system is no longer registered") {
+				REQUIRE(world->get_system_count() == system_count);
+			}
+		}
+	}
+}
+
+SCENARIO("world ticks systems on workers and replays their commands", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("a world with two workers, a system on cooldown and another system affected by it") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// World
+		auto world = GameplayWorld::get_singleton();
+		world->set_worker_count(2);
+		auto _workers = finally([world] { world->set_worker_count(0); });
+
+		// Systems
+		auto source = make_gameplay_ptr<GameplayAbilitySystem>();
+		source->set_attribute_set(make_reference<TestAttributeSet>());
+		source->set_world_processing(true);
+		root->add_child(source.get());
+
+		auto target = make_gameplay_ptr<GameplayAbilitySystem>();
+		target->set_attribute_set(make_reference<TestAttributeSet>());
+		target->set_world_processing(true);
+		root->add_child(target.get());
+
+		// Ability
+		auto ability = make_gameplay_ptr<AttackAbility>();
+		source->add_ability(ability.get());
+
+		// Listener
+		auto listener = make_gameplay_ptr<AbilityReadyListener>();
+		source->connect("gameplay_ability_ready", listener.get(), "_on_ability_ready");
+
+		auto effect = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_parallel_effect");
+			effect->set_duration_type(DurationType::HasDuration);
+			effect->set_duration_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(10);
+			}));
+			effect->get_target_tags()->append("parallel");
+		});
+
+		source->apply_effect(source.get(), ability->get_cooldown_effect());
+		target->apply_effect(source.get(), effect);
+		scene_tree->idle(delta);
+		world->process(delta);
+
+		WHEN("the world ticked once") {
+			THEN("both systems advanced") {
+				CHECK(ability->get_remaining_cooldown() == 4);
+				CHECK(target->get_remaining_effect_duration(effect) == 4.0);
+				REQUIRE(listener->ready_count == 0);
+			}
+		}
+
+		WHEN("the world ticked past the durations") {
+			world->process(delta);
+
+			THEN("effects ended and recorded signals were replayed once") {
+				CHECK(ability->get_remaining_cooldown() == 0);
+				CHECK(!target->get_active_tags()->has_tag("parallel"));
+				REQUIRE(listener->ready_count == 1);
+			}
+		}
+	}
+}
+
+SCENARIO("world ticks unconnected islands sharing one effect", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("a world with two workers and systems each affected by the same periodic effect") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// World
+		auto world = GameplayWorld::get_singleton();
+		world->set_worker_count(2);
+		auto _workers = finally([world] { world->set_worker_count(0); });
+
+		// Effects, magnitude programs, baked curves and the expiration spec are built on first use by the workers.
+		auto expiration = make_reference<GameplayEffect>([](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_shared_expiration");
+
+			Array modifiers;
+			modifiers.append(make_reference<GameplayEffectModifier>([](Ref<GameplayEffectModifier> modifier) {
+				modifier->set_attribute(health);
+				modifier->set_modifier_operation(ModifierOperation::Subtract);
+				modifier->set_modifier_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+					magnitude->set_value(10);
+				}));
+			}));
+			effect->set_modifiers(modifiers);
+		});
+		auto effect = make_reference<GameplayEffect>([&](Ref<GameplayEffect> effect) {
+			effect->set_effect_name("test_shared_effect");
+			effect->get_effect_tags()->append("test.shared");
+			effect->set_duration_type(DurationType::HasDuration);
+			effect->set_duration_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(3);
+			}));
+			effect->set_period(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(1);
+			}));
+
+			Array modifiers;
+			modifiers.append(make_reference<GameplayEffectModifier>([](Ref<GameplayEffectModifier> modifier) {
+				modifier->set_attribute(health);
+				modifier->set_modifier_operation(ModifierOperation::Subtract);
+				modifier->set_modifier_magnitude(make_reference<AttributeBasedFloat>([](Ref<AttributeBasedFloat> magnitude) {
+					magnitude->set_attribute_origin(AttributeOrigin::Target);
+					magnitude->set_backing_attribute(attack);
+					magnitude->set_coefficient(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+						magnitude->set_value(0.1);
+						magnitude->set_bake_resolution(16);
+						magnitude->set_curve(make_reference<Curve>([](Ref<Curve> curve) {
+							curve->add_point(Vector2(0, 0), 0, 1);
+							curve->add_point(Vector2(1, 1), 1, 0);
+						}));
+					}));
+				}));
+			}));
+			effect->set_modifiers(modifiers);
+
+			Array expiration_effects;
+			expiration_effects.append(expiration);
+			effect->set_normal_expiration_effects(expiration_effects);
+		});
+
+		// Systems, each one is its own source and forms its own island.
+		constexpr auto system_count = 4;
+		GameplayPtr<GameplayAbilitySystem> systems[system_count];
+
+		for (auto &&system : systems) {
+			system = make_gameplay_ptr<GameplayAbilitySystem>();
+			system->set_attribute_set(make_reference<TestAttributeSet>());
+			system->set_world_processing(true);
+			root->add_child(system.get());
+			system->apply_effect(system.get(), effect);
+		}
+
+		scene_tree->idle(delta);
+
+		WHEN("the world ticked past the duration") {
+			world->process(delta);
+
+			THEN("every island executed all periods and the expiration effect") {
+				auto finished = 0;
+
+				for (auto &&system : systems) {
+					CHECK(system->query_active_effects_by_tag("test.shared").empty());
+					finished += system->get_current_attribute_value(health) == 60.0;
+				}
+
+				REQUIRE(finished == system_count);
+			}
+		}
+	}
+}
+
+SCENARIO("periodic effects catch up on elapsed periods", "[effects]") {
+	auto scene_tree = make_gameplay_ptr<TestSceneTree>();
+
+	GIVEN("system and effects with a period of two seconds") {
+		// Scene Tree
+		auto _ = finally([&scene_tree] { scene_tree->finish(); });
+		auto root = make_gameplay_ptr<Node>();
+		scene_tree->call("_change_scene", root.get());
+		scene_tree->init();
+
+		// System
+		auto attributes = make_reference<TestAttributeSet>();
+		auto system = make_gameplay_ptr<GameplayAbilitySystem>();
+		system->set_attribute_set(attributes);
+		root->add_child(system.get());
+
+		auto make_effect = [](ModifierOperation::Type operation, double value) {
+			return make_reference<GameplayEffect>([&](Ref<GameplayEffect> effect) {
+				Array modifiers;
+				modifiers.append(make_reference<GameplayEffectModifier>([&](Ref<GameplayEffectModifier> modifier) {
+					modifier->set_attribute(health);
+					modifier->set_modifier_operation(operation);
+					modifier->set_modifier_magnitude(make_reference<ScalableFloat>([&](Ref<ScalableFloat> magnitude) {
+						magnitude->set_value(value);
+					}));
+				}));
+				effect->set_modifiers(modifiers);
+				effect->set_duration_type(DurationType::Infinite);
+				effect->set_period(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+					magnitude->set_value(2);
+				}));
+			});
+		};
+
+		WHEN("a linear effect misses three periods within one update") {
+			system->apply_effect(system.get(), make_effect(ModifierOperation::Subtract, 5));
+			scene_tree->idle(delta);
+
+			THEN("all three periods are applied in one batch") {
+				REQUIRE(system->get_current_attribute_value(health) == 85.0);
+			}
+		}
+
+		WHEN("a multiplying effect misses three periods within one update") {
+			system->apply_effect(system.get(), make_effect(ModifierOperation::Multiply, 0.5));
+			scene_tree->idle(delta);
+
+			THEN("every period is executed") {
+				REQUIRE(system->get_current_attribute_value(health) == 12.5);
+			}
+		}
+
+		WHEN("an effect with a duration of five seconds and a period of one second misses its whole duration") {
+			auto effect = make_effect(ModifierOperation::Subtract, 5);
+			effect->get_effect_tags()->append("test.periodic");
+			effect->set_duration_type(DurationType::HasDuration);
+			effect->set_duration_magnitude(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(5);
+			}));
+			effect->set_period(make_reference<ScalableFloat>([](Ref<ScalableFloat> magnitude) {
+				magnitude->set_value(1);
+			}));
+			system->apply_effect(system.get(), effect);
+			scene_tree->idle(10);
+
+			THEN("only periods up to its expiration are executed") {
+				CHECK(system->query_active_effects_by_tag("test.periodic").empty());
+				REQUIRE(system->get_current_attribute_value(health) == 75.0);
+			}
+		}
+	}
+}
+
+SCENARIO("effects are compiled into specs", "[effects]") {
+	GIVEN("effect with a constant subtracting modifier") {
+		Ref<GameplayEffectModifier> modifier = make_reference<GameplayEffectModifier>([](Ref<GameplayEffectModifier> modifier) {
+			modifier->set_attribute(health);
+			modifier->set_modifier_operation(ModifierOperation::Subtract);
+			modifier->set_modifier_magnitude(make_reference<ScalableFloat>());
+		});
+		auto effect = make_reference<GameplayEffect>([&](Ref<GameplayEffect> effect) {
+			Array modifiers;
+			modifiers.append(modifier);
+			effect->set_modifiers(modifiers);
+			effect->set_duration_type(DurationType::Infinite);
+		});
+
+		WHEN("spec is requested twice") {
+			auto first = effect->get_spec();
+			auto second = effect->get_spec();
+
+			THEN("compiled spec is shared") {
+				CHECK(first == second);
+				CHECK(first->get_modifiers().size() == 1);
+				CHECK(first->is_aggregated());
+				REQUIRE(first->is_linear());
+			}
+		}
+
+		WHEN("effect or modifier change") {
+			auto first = effect->get_spec();
+			modifier->set_modifier_operation(ModifierOperation::Multiply);
+			auto second = effect->get_spec();
+			effect->set_duration_type(DurationType::Instant);
+			auto third = effect->get_spec();
+
+			THEN("spec is compiled again") {
+				CHECK(first != second);
+				CHECK(!second->is_linear());
+				CHECK(second != third);
+				REQUIRE(!third->is_aggregated());
+			}
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region attribute sets
+
+SCENARIO("attribute sets share schemas and expose views", "[attributes]") {
+	GIVEN("two sets built from the same definition") {
+		auto first = make_reference<TestAttributeSet>();
+		auto second = make_reference<TestAttributeSet>();
+
+		WHEN("comparing their schemas") {
+			THEN("both use the same schema with dense indices") {
+				CHECK(first->get_schema() == second->get_schema());
+				CHECK(first->get_attribute_count() == 12);
+				CHECK(first->get_attribute_index(max_health) == 0);
+				CHECK(first->get_attribute_index(luck) == 11);
+				REQUIRE(first->get_attribute_index("unknown") == GAMEPLAY_ATTRIBUTE_INVALID);
+			}
+		}
+
+		WHEN("values are written through a view") {
+			auto data = first->get_attribute_data(health);
+			data->set_current_value(42);
+
+			THEN("only the owning set changes") {
+				CHECK(first->get_current_value(first->get_attribute_index(health)) == 42);
+				CHECK(second->get_current_value(second->get_attribute_index(health)) == 100);
+				REQUIRE(first->get_attribute_data(health) == data);
+			}
+		}
+
+		WHEN("an attribute is removed") {
+			auto data = first->get_attribute_data(luck);
+			first->set_base_value(first->get_attribute_index(luck), 7);
+			first->remove_attribute(mana);
+
+			THEN("remaining attributes keep their values and views") {
+				CHECK_FALSE(first->has_attribute(mana));
+				CHECK(first->get_schema() != second->get_schema());
+				CHECK(first->get_attribute_index(luck) == 10);
+				CHECK(data->get_base_value() == 7);
+				REQUIRE(first->get_schema() == first->get_schema()->without_attribute(mana));
+			}
+		}
+	}
+}
+
+SCENARIO("attribute handles are resolved once per schema", "[attributes]") {
+	GIVEN("handle to an attribute and sets with different schemas") {
+		auto full = make_reference<TestAttributeSet>();
+		auto reduced = make_reference<TestAttributeSet>();
+		reduced->remove_attribute(max_health);
+
+		GameplayAttributeHandle handle;
+		handle.set_name(health);
+
+		WHEN("resolving against both sets") {
+			THEN("each set yields its own index") {
+				CHECK(handle.resolve(full.ptr()) == 1);
+				CHECK(handle.resolve(reduced.ptr()) == 0);
+				REQUIRE(handle.resolve(full.ptr()) == full->get_attribute_index(health));
+			}
+		}
+
+		WHEN("the attribute is missing") {
+			reduced->remove_attribute(health);
+
+			THEN("handle resolves to an invalid index") {
+				REQUIRE(handle.resolve(reduced.ptr()) == GAMEPLAY_ATTRIBUTE_INVALID);
+			}
+		}
+
+		WHEN("the attribute is missing from one of two sets resolved alternately") {
+			reduced->remove_attribute(health);
+
+			for (int i = 0; i < 4; i++) {
+				handle.resolve(full.ptr());
+				handle.resolve(reduced.ptr());
+			}
+
+			THEN("both schemas stay resolved and the missing attribute was reported once") {
+				CHECK(handle.resolve(full.ptr()) == 1);
+				CHECK(handle.resolve(reduced.ptr()) == GAMEPLAY_ATTRIBUTE_INVALID);
+				REQUIRE_FALSE(reduced->get_schema()->report_missing(health));
+			}
+		}
+	}
+}
+
+SCENARIO("attribute modifiers are aggregated and removable", "[attributes]") {
+	GIVEN("attribute set with additive, multiplicative and override modifiers") {
+		auto attributes = make_reference<TestAttributeSet>();
+		auto index = attributes->get_attribute_index(attack);
+
+		GameplayAttributeModifier add;
+		add.index = index;
+		add.magnitude = 20;
+
+		GameplayAttributeModifier multiply;
+		multiply.index = index;
+		multiply.type = GameplayAttributeModifier::Multiplicative;
+		multiply.magnitude = 1.5;
+
+		GameplayAttributeModifier override;
+		override.index = index;
+		override.type = GameplayAttributeModifier::Override;
+		override.magnitude = 5;
+
+		attributes->add_modifier(multiply);
+		attributes->add_modifier(add);
+
+		WHEN("reading the current value") {
+			THEN("adds are applied before multipliers regardless of order") {
+				CHECK(attributes->get_base_value(index) == 100);
+				REQUIRE(attributes->get_current_value(index) == 180);
+			}
+		}
+
+		WHEN("an override is active") {
+			attributes->add_modifier(override);
+
+			THEN("override wins until it is removed") {
+				CHECK(attributes->get_current_value(index) == 5);
+				attributes->remove_modifier(override);
+				REQUIRE(attributes->get_current_value(index) == 180);
+			}
+		}
+
+		WHEN("modifiers are removed") {
+			attributes->remove_modifier(add);
+			attributes->remove_modifier(multiply);
+
+			THEN("current value returns to base") {
+				REQUIRE(attributes->get_current_value(index) == 100);
+			}
+		}
+
+		WHEN("the current value is written explicitly") {
+			attributes->set_current_value(index, 150);
+			attributes->remove_modifier(add);
+
+			THEN("the write is kept relative to the remaining modifiers") {
+				CHECK(attributes->get_current_value(index) == 120);
+				CHECK(attributes->get_base_value(index) == 100);
+				attributes->reset_current_value(index);
+				REQUIRE(attributes->get_current_value(index) == 150);
+			}
+		}
+
+		WHEN("an override is added after the current value was written") {
+			attributes->set_current_value(index, 150);
+			attributes->add_modifier(override);
+
+			THEN("the override pins the value until it is removed") {
+				CHECK(attributes->get_current_value(index) == 5);
+				attributes->set_current_value(index, 40);
+				CHECK(attributes->get_current_value(index) == 5);
+				attributes->remove_modifier(override);
+				REQUIRE(attributes->get_current_value(index) == 150);
+			}
+		}
+
+		WHEN("the base value is updated without resetting the current value") {
+			attributes->update_attribute(attack, 50, false);
+			attributes->add_modifier(override);
+			attributes->remove_modifier(override);
+
+			THEN("the current value survives recomputation") {
+				CHECK(attributes->get_base_value(index) == 50);
+				REQUIRE(attributes->get_current_value(index) == 180);
+			}
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region tag containers
+
+SCENARIO("tags are interned with their parents", "[tags]") {
+	GIVEN("tag registry") {
+		auto registry = GameplayTagRegistry::get_singleton();
+
+		WHEN("hierarchical tag is interned") {
+			auto id = registry->intern("Registry.Status.Stun");
+
+			THEN("tag and parents are registered case-insensitive") {
+				auto parent = registry->find("registry.status");
+				CHECK(id != GAMEPLAY_TAG_INVALID);
+				CHECK(registry->find("REGISTRY.STATUS.STUN") == id);
+				CHECK(registry->find("Registry.Status.Stun") == id);
+				CHECK(registry->intern("registry.status.STUN") == id);
+				CHECK(registry->find("registry.status.STUN") == id);
+				CHECK(registry->get_parent(id) == parent);
+				CHECK(registry->get_depth(id) == 2);
+				CHECK(registry->is_child_of(id, registry->find("registry")));
+				CHECK_FALSE(registry->is_child_of(parent, id));
+				REQUIRE(registry->intern("registry.*") == GAMEPLAY_TAG_INVALID);
+			}
+		}
+	}
+}
+
+SCENARIO("tag container matches interned and wildcard tags", "[tags]") {
+	GIVEN("container with hierarchical tags") {
+		auto tags = make_reference<GameplayTagContainer>([](Ref<GameplayTagContainer> tags) {
+			tags->append("container.status.stun");
+			tags->append("container.status.burn");
+			tags->append("container.ability");
+		});
+
+		WHEN("querying exact tags") {
+			THEN("matches are case-insensitive and parents are not implied") {
+				CHECK(tags->has_tag("Container.Status.Stun"));
+				CHECK(tags->has_tag(""));
+				CHECK_FALSE(tags->has_tag("container.status"));
+				REQUIRE_FALSE(tags->has_tag("container.unknown"));
+			}
+		}
+
+		WHEN("querying wildcard tags") {
+			THEN("glob semantics are unchanged") {
+				CHECK(tags->has_tag("container.status.*"));
+				CHECK(tags->has_tag("*.burn"));
+				REQUIRE_FALSE(tags->has_tag("container.?"));
+			}
+		}
+
+		WHEN("querying other containers") {
+			auto query = make_reference<GameplayTagContainer>([](Ref<GameplayTagContainer> query) {
+				query->append("container.ability");
+				query->append("container.status.*");
+			});
+
+			THEN("mixed exact and wildcard entries are matched") {
+				CHECK(tags->has_all(query));
+				query->append("container.missing");
+				CHECK_FALSE(tags->has_all(query));
+				CHECK(tags->has_any(query));
+				REQUIRE_FALSE(tags->has_none(query));
+			}
+		}
+
+		WHEN("removing tags") {
+			tags->remove("container.status.*");
+			tags->remove("CONTAINER.ABILITY");
+
+			THEN("container is empty") {
+				REQUIRE(tags->empty());
+			}
+		}
+	}
+}
+
+SCENARIO("tag container set queries span multiple bitset words", "[tags]") {
+	GIVEN("containers with more tags than fit into a single word") {
+		auto owned = make_reference<GameplayTagContainer>();
+		auto required = make_reference<GameplayTagContainer>();
+		auto blocked = make_reference<GameplayTagContainer>();
+
+		for (int i = 0; i < 300; i++) {
+			owned->append("bitset.owned." + itos(i));
+		}
+		for (int i = 0; i < 300; i += 7) {
+			required->append("bitset.owned." + itos(i));
+		}
+		blocked->append("bitset.blocked");
+
+		WHEN("querying subsets") {
+			THEN("queries are answered over all words") {
+				CHECK(owned->has_all(required));
+				CHECK(owned->has_none(blocked));
+				CHECK_FALSE(required->has_all(owned));
+				REQUIRE(required->has_any(owned));
+			}
+		}
+
+		WHEN("a required tag gets removed") {
+			owned->remove("bitset.owned.294");
+
+			THEN("requirement fails") {
+				CHECK_FALSE(owned->has_all(required));
+				REQUIRE_FALSE(owned->has_tag("bitset.owned.294"));
+			}
+		}
+
+		WHEN("a duplicate is removed by wildcard") {
+			owned->append_tags(required);
+			owned->remove("bitset.owned.29?");
+
+			THEN("all duplicates are gone") {
+				CHECK_FALSE(owned->has_tag("bitset.owned.294"));
+				REQUIRE(owned->has_tag("bitset.owned.287"));
+			}
+		}
+	}
+}
+
+SCENARIO("compiled tag patterns match like matchn", "[tags]") {
+	GIVEN("tags and patterns of every kind") {
+		const char *tags[] = { "Status.Debuff.Stun", "status.buff", "ability.attack.stun", "status", "a.b" };
+		const char *patterns[] = { "status.debuff.stun", "*", "status.*", "*.stun", "status.*.stun", "?.?", "*.?", "st?tus*", "ability.*.*", "" };
+
+		WHEN("patterns are compiled once") {
+			THEN("every tag matches exactly as with matchn") {
+				for (auto &&pattern : patterns) {
+					GameplayTagPattern compiled(pattern);
+
+					for (auto &&tag : tags) {
+						INFO(pattern << " / " << tag);
+						REQUIRE(compiled.match(tag) == String(tag).matchn(pattern));
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("tag container answers hierarchical queries", "[tags]") {
+	GIVEN("container with a nested tag") {
+		auto tags = make_reference<GameplayTagContainer>([](Ref<GameplayTagContainer> tags) {
+			tags->append("hierarchy.status.debuff.stun");
+		});
+
+		WHEN("querying parents") {
+			THEN("only hierarchical queries match parents") {
+				CHECK(tags->has_tag_exact("hierarchy.status.debuff.stun"));
+				CHECK_FALSE(tags->has_tag_exact("hierarchy.status.debuff"));
+				CHECK(tags->has_tag_hierarchical("hierarchy.status.debuff"));
+				CHECK(tags->has_tag_hierarchical("Hierarchy"));
+				CHECK(tags->has_tag("hierarchy.status.*"));
+				REQUIRE_FALSE(tags->has_tag_hierarchical("hierarchy.status.buff"));
+			}
+		}
+
+		WHEN("querying unknown tags") {
+			auto registry = GameplayTagRegistry::get_singleton();
+			auto tag_count = registry->get_tag_count();
+			auto matched = tags->has_tag("hierarchy.unknown.*") || tags->has_tag_pattern(GameplayTagPattern("hierarchy.unknown.tag"));
+
+			THEN("nothing matches and no tag is interned by the queries") {
+				CHECK_FALSE(matched);
+				REQUIRE(registry->get_tag_count() == tag_count);
+			}
+		}
+
+		WHEN("the nested tag is removed") {
+			tags->remove("hierarchy.status.debuff.stun");
+
+			THEN("parents are no longer matched") {
+				CHECK_FALSE(tags->has_tag_hierarchical("hierarchy.status"));
+				REQUIRE_FALSE(tags->has_tag("hierarchy.*"));
+			}
+		}
+
+		WHEN("a sibling and a duplicate are added and removed one by one") {
+			tags->append("hierarchy.status.buff");
+			tags->append("hierarchy.status.debuff.stun");
+			tags->remove_tag_id(GameplayTagRegistry::get_singleton()->find("hierarchy.status.debuff.stun"));
+
+			THEN("every duplicate is removed and the sibling keeps the shared parents") {
+				CHECK(tags->size() == 1);
+				CHECK(tags->get_tag(0) == "hierarchy.status.buff");
+				CHECK_FALSE(tags->has_tag_hierarchical("hierarchy.status.debuff"));
+				REQUIRE(tags->has_tag_hierarchical("hierarchy.status"));
+			}
+		}
+	}
+}
+
 #pragma endregion
 
 namespace TestGameplayAbilities {
@@ -0,0 +1,337 @@
+#include "gameplay_world.h"
+#include "gameplay_ability_system.h"
+
+#include <algorithm>
+
+GameplayWorld *GameplayWorld::singleton = nullptr;
+
+namespace {
+int find_island(Vector<int> &parents, int index) {
+	auto data = parents.ptrw();
+
+	while (data[index] != index) {
+		data[index] = data[data[index]];
+		index = data[index];
+	}
+
+	return index;
+}
+} // namespace
+
+GameplayWorld::GameplayWorld() {
+	singleton = this;
+}
+
+GameplayWorld::~GameplayWorld() {
+	stop_workers();
+
+	for (auto system : systems) {
+		if (system) {
+			system->world_index = -1;
+		}
+	}
+
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
+
+GameplayWorld *GameplayWorld::get_singleton() {
+	return singleton;
+}
+
+void GameplayWorld::register_system(GameplayAbilitySystem *system) {
+	ERR_FAIL_NULL(system);
+	ERR_FAIL_COND(system->world_index >= 0);
+
+	system->world_index = systems.size();
+	systems.push_back(system);
+}
+
+void GameplayWorld::unregister_system(GameplayAbilitySystem *system) {
+	ERR_FAIL_NULL(system);
+	ERR_FAIL_INDEX(system->world_index, systems.size());
+	ERR_FAIL_COND(systems[system->world_index] != system);
+
+	auto index = system->world_index;
+	system->world_index = -1;
+
+	if (ticking) {
+		// Keep indices stable for the running tick.
+		systems.set(index, nullptr);
+		has_removed_systems = true;
+	} else {
+		auto last = systems[systems.size() - 1];
+		systems.set(index, last);
+		last->world_index = index;
+		systems.resize(systems.size() - 1);
+	}
+}
+
+int64_t GameplayWorld::get_system_count() const {
+	auto result = systems.size();
+
+	if (has_removed_systems) {
+		result -= std::count(begin(systems), end(systems), nullptr);
+	}
+
+	return result;
+}
+
+void GameplayWorld::process(double delta) {
+	// Effects and cooldowns first, so abilities see the state of this tick.
+	if (workers.empty()) {
+		tick_systems([delta](GameplayAbilitySystem *system) {
+			system->process_effects(delta);
+		});
+	} else {
+		tick_islands(delta);
+	}
+
+	// Abilities run script callbacks and always tick on the main thread.
+	tick_systems([delta](GameplayAbilitySystem *system) {
+		system->process_abilities(delta);
+	});
+}
+
+void GameplayWorld::physics_process() {
+	tick_systems([](GameplayAbilitySystem *system) {
+		system->process_ability_input();
+	});
+}
+
+void GameplayWorld::set_worker_count(int64_t value) {
+	ERR_FAIL_COND(value < 0);
+	ERR_FAIL_COND(ticking);
+
+	if (value != workers.size()) {
+		stop_workers();
+		start_workers(value);
+	}
+}
+
+int64_t GameplayWorld::get_worker_count() const {
+	return workers.size();
+}
+
+template <class Function>
+void GameplayWorld::tick_systems(Function &&function) {
+	ERR_FAIL_COND(ticking);
+	ticking = true;
+
+	// Systems registered while ticking are appended and ticked as well.
+	for (int i = 0; i < systems.size(); i++) {
+		if (auto system = systems[i]) {
+			function(system);
+		}
+	}
+
+	ticking = false;
+	compact_systems();
+}
+
+void GameplayWorld::compact_systems() {
+	if (!has_removed_systems) {
+		return;
+	}
+
+	auto count = 0;
+	auto data = systems.ptrw();
+
+	for (int i = 0, n = systems.size(); i < n; i++) {
+		if (auto system = data[i]) {
+			system->world_index = count;
+			data[count++] = system;
+		}
+	}
+
+	systems.resize(count);
+	has_removed_systems = false;
+}
+
+void GameplayWorld::build_islands() {
+	auto count = systems.size();
+	Vector<int> parents;
+	parents.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		parents.ptrw()[i] = i;
+	}
+
+	// Sources which aren't registered get a slot after the registered systems, systems sharing them must not tick concurrently either.
+	Vector<GameplayAbilitySystem *> unregistered_sources;
+
+	// Effects read and stack on their source, so both systems have to tick on the same thread.
+	for (int i = 0; i < count; i++) {
+		auto system = systems[i];
+
+		for (auto index : system->active_effects) {
+			auto source = system->get_effect_record(index).source;
+
+			if (source && source != system) {
+				auto slot = source->world_index;
+
+				if (slot < 0) {
+					auto unregistered = unregistered_sources.find(source);
+
+					if (unregistered < 0) {
+						unregistered = unregistered_sources.size();
+						unregistered_sources.push_back(source);
+						parents.push_back(count + unregistered);
+					}
+
+					slot = count + unregistered;
+				}
+
+				auto a = find_island(parents, i);
+				auto b = find_island(parents, slot);
+
+				// The lower slot becomes the root, so islands are ordered by their first system and rooted in a registered one.
+				parents.ptrw()[MAX(a, b)] = MIN(a, b);
+			}
+		}
+	}
+
+	// Counting sort of slots by island keeps systems in order of registration within their island.
+	Vector<int> island_of;
+	Vector<int> sizes;
+	island_of.resize(count);
+	sizes.resize(count);
+	std::fill(sizes.ptrw(), sizes.ptrw() + count, 0);
+
+	for (int i = 0; i < count; i++) {
+		auto root = find_island(parents, i);
+		island_of.ptrw()[i] = root;
+		sizes.ptrw()[root]++;
+	}
+
+	island_offsets.clear();
+	Vector<int> starts;
+	starts.resize(count);
+	auto offset = 0;
+
+	for (int i = 0; i < count; i++) {
+		if (sizes[i] > 0) {
+			starts.ptrw()[i] = offset;
+			island_offsets.push_back(offset);
+			offset += sizes[i];
+		}
+	}
+
+	island_offsets.push_back(offset);
+	island_systems.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		island_systems.ptrw()[starts.ptrw()[island_of[i]]++] = i;
+	}
+}
+
+void GameplayWorld::tick_islands(double delta) {
+	ERR_FAIL_COND(ticking);
+	ticking = true;
+
+	build_islands();
+	island_buffers.resize(island_offsets.size() - 1);
+	tick_delta = delta;
+	next_island.store(0);
+
+	for (int i = 0, n = workers.size(); i < n; i++) {
+		work_semaphore->post();
+	}
+
+	process_islands();
+
+	for (int i = 0, n = workers.size(); i < n; i++) {
+		done_semaphore->wait();
+	}
+
+	ticking = false;
+
+	// Sync point, commands are replayed in island order regardless of which thread ticked an island.
+	for (int i = 0, n = island_buffers.size(); i < n; i++) {
+		island_buffers.ptrw()[i].flush();
+	}
+
+	compact_systems();
+}
+
+void GameplayWorld::process_islands() {
+	auto island_count = island_buffers.size();
+	auto buffers = island_buffers.ptrw();
+	auto offsets = island_offsets.ptr();
+	auto slots = island_systems.ptr();
+	auto registered = systems.ptr();
+	auto delta = tick_delta;
+
+	for (auto island = next_island++; island < island_count; island = next_island++) {
+		GameplayCommandBuffer::set_current(&buffers[island]);
+
+		for (int i = offsets[island]; i < offsets[island + 1]; i++) {
+			registered[slots[i]]->process_effects(delta);
+		}
+
+		GameplayCommandBuffer::set_current(nullptr);
+	}
+}
+
+void GameplayWorld::start_workers(int count) {
+	if (count <= 0) {
+		return;
+	}
+
+	work_semaphore = GameplayPtr<Semaphore>(Semaphore::create());
+	done_semaphore = GameplayPtr<Semaphore>(Semaphore::create());
+	workers_exiting.store(false);
+
+	for (int i = 0; i < count; i++) {
+		workers.push_back(Thread::create(&GameplayWorld::_worker_main, this));
+	}
+}
+
+void GameplayWorld::stop_workers() {
+	if (workers.empty()) {
+		return;
+	}
+
+	workers_exiting.store(true);
+
+	for (int i = 0, n = workers.size(); i < n; i++) {
+		work_semaphore->post();
+	}
+
+	for (auto worker : workers) {
+		Thread::wait_to_finish(worker);
+		memdelete(worker);
+	}
+
+	workers.clear();
+	work_semaphore = nullptr;
+	done_semaphore = nullptr;
+}
+
+void GameplayWorld::_worker_main(void *userdata) {
+	auto world = static_cast<GameplayWorld *>(userdata);
+
+	while (true) {
+		world->work_semaphore->wait();
+
+		if (world->workers_exiting.load()) {
+			return;
+		}
+
+		world->process_islands();
+		world->done_semaphore->post();
+	}
+}
+
+void GameplayWorld::_bind_methods() {
+	/** Methods */
+	ClassDB::bind_method(D_METHOD("get_system_count"), &GameplayWorld::get_system_count);
+	ClassDB::bind_method(D_METHOD("process", "delta"), &GameplayWorld::process);
+	ClassDB::bind_method(D_METHOD("physics_process"), &GameplayWorld::physics_process);
+	ClassDB::bind_method(D_METHOD("set_worker_count", "value"), &GameplayWorld::set_worker_count);
+	ClassDB::bind_method(D_METHOD("get_worker_count"), &GameplayWorld::get_worker_count);
+
+	/** Properties */
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "worker_count"), "set_worker_count", "get_worker_count");
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "gameplay_api.h"
+#include "gameplay_node.h"
+
+#include <core/object.h>
+#include <core/os/semaphore.h>
+#include <core/os/thread.h>
+#include <core/vector.h>
+
+#include <atomic>
+
+class GameplayAbilitySystem;
+
+/**
+ * Ticks every registered ability system in a single loop instead of one process notification per node.
+ * Systems register themselves while world processing is enabled and they're inside the tree.
+ *
+ * With workers, effects of independent systems are ticked in parallel. Systems linked by effects from one another form an island
+ * which is ticked on a single thread. Signals, deferred calls and deletions are recorded per island and replayed in island order,
+ * which only depends on the order of registration, so results don't depend on the amount of workers.
+ * Script based calculations and executions must be thread safe when ticking in parallel.
+ */
+class GAMEPLAY_ABILITIES_API GameplayWorld : public Object {
+	GDCLASS(GameplayWorld, Object);
+	OBJ_CATEGORY("GameplayAbilities");
+
+public:
+	GameplayWorld();
+	virtual ~GameplayWorld();
+
+	static GameplayWorld *get_singleton();
+
+	/** Adds a system to the systems ticked by this world. */
+	void register_system(GameplayAbilitySystem *system);
+	/** Removes a system, safe to call while the world is ticking. */
+	void unregister_system(GameplayAbilitySystem *system);
+	/** Gets the amount of registered systems. */
+	int64_t get_system_count() const;
+
+	/** Advances effects, cooldowns and ability waits of all systems, usually called from the _process of an autoload. */
+	void process(double delta);
+	/** Polls ability input of all systems, usually called from the _physics_process of an autoload. */
+	void physics_process();
+
+	/** Sets the amount of worker threads ticking effects in parallel with the main thread, 0 ticks on the main thread only. */
+	void set_worker_count(int64_t value);
+	int64_t get_worker_count() const;
+
+private:
+	static GameplayWorld *singleton;
+
+	/** Registered systems, slots of systems removed while ticking are null until the tick ends. */
+	Vector<GameplayAbilitySystem *> systems;
+	/** True while systems are ticked. */
+	bool ticking = false;
+	/** True if systems got removed while ticking. */
+	bool has_removed_systems = false;
+
+	/** Slots of systems sorted by island, islands are ordered by their first system. */
+	Vector<int> island_systems;
+	/** Start of each island in island_systems, followed by the total amount of systems. */
+	Vector<int> island_offsets;
+	/** Commands recorded by each island during a parallel tick. */
+	Vector<GameplayCommandBuffer> island_buffers;
+
+	Vector<Thread *> workers;
+	GameplayPtr<Semaphore> work_semaphore;
+	GameplayPtr<Semaphore> done_semaphore;
+	/** Next island to be claimed by a thread. */
+	std::atomic<int> next_island{ 0 };
+	std::atomic<bool> workers_exiting{ false };
+	double tick_delta = 0;
+
+	template <class Function>
+	void tick_systems(Function &&function);
+	/** Removes the null slots of systems removed while ticking. */
+	void compact_systems();
+
+	/** Groups systems which share effects into islands, including systems sharing a source which isn't registered. */
+	void build_islands();
+	/** Ticks effects of all islands on the main thread and the workers, then replays the recorded commands. */
+	void tick_islands(double delta);
+	/** Claims and ticks islands until none are left. */
+	void process_islands();
+	void start_workers(int count);
+	void stop_workers();
+	static void _worker_main(void *userdata);
+
+	static void _bind_methods();
+};
@@ -3,14 +3,34 @@
 #include "gameplay_ability.h"
 #include "gameplay_ability_system.h"
 #include "gameplay_attribute.h"
+#include "gameplay_calculator.h"
 #include "gameplay_effect.h"
 #include "gameplay_effect_magnitude.h"
 #include "gameplay_node.h"
 #include "gameplay_tags.h"
+#include "gameplay_world.h"
 
 #include <core/class_db.h>
+#include <core/engine.h>
+
+namespace {
+GameplayTagRegistry *tag_registry = nullptr;
+GameplayCalculatorRegistry *calculator_registry = nullptr;
+GameplayWorld *world = nullptr;
+}
 
 void register_gameplay_abilities_types() {
+	/** Singletons */
+	ClassDB::register_class<GameplayTagRegistry>();
+	tag_registry = memnew(GameplayTagRegistry);
+	Engine::get_singleton()->add_singleton(Engine::Singleton("GameplayTagRegistry", GameplayTagRegistry::get_singleton()));
+	ClassDB::register_class<GameplayCalculatorRegistry>();
+	calculator_registry = memnew(GameplayCalculatorRegistry);
+	Engine::get_singleton()->add_singleton(Engine::Singleton("GameplayCalculatorRegistry", GameplayCalculatorRegistry::get_singleton()));
+	ClassDB::register_class<GameplayWorld>();
+	world = memnew(GameplayWorld);
+	Engine::get_singleton()->add_singleton(Engine::Singleton("GameplayWorld", GameplayWorld::get_singleton()));
+
 	/** Nodes */
 	ClassDB::register_class<GameplayAbilitySystem>();
 	ClassDB::register_class<GameplayEffectNode>();
@@ -21,6 +41,7 @@ void register_gameplay_abilities_types() {
 	ClassDB::register_class<AttributeBasedFloat>();
 	ClassDB::register_class<CustomCalculatedFloat>();
 	ClassDB::register_class<CustomMagnitudeCalculator>();
+	ClassDB::register_class<ExpressionFloat>();
 	ClassDB::register_class<GameplayAttributeData>();
 	ClassDB::register_class<GameplayTagContainer>();
 	ClassDB::register_class<GameplayEffectModifier>();
@@ -39,4 +60,16 @@ void register_gameplay_abilities_types() {
 }
 
 void unregister_gameplay_abilities_types() {
+	if (world) {
+		memdelete(world);
+		world = nullptr;
+	}
+	if (calculator_registry) {
+		memdelete(calculator_registry);
+		calculator_registry = nullptr;
+	}
+	if (tag_registry) {
+		memdelete(tag_registry);
+		tag_registry = nullptr;
+	}
 }